@@ -5,9 +5,14 @@
 #include "basic/typedef.h"
 #include "basic/geometrical predicates/predicates_wrapper.h"
 #include "mesh loader/mesh_loader.h"
-#include "basic/data structure/memory_pool.h"
+#include "basic/compact_mesh.h"
+#include "basic/data structure/bvh.h"
+#include "basic/data structure/union_find.h"
+#include "basic/data structure/radix_sort.h"
+#include "basic/geometrical predicates/ray_triangle_batch.h"
 #include "basic/math/vector3.h"
 #include "config/config_loader.h"
+#include "utils/parallel/task_pool.h"
 
 using namespace base_type;
 
@@ -42,7 +47,7 @@ inline base_type::Vector3 Rotate3d(base_type::Vector3 point, double yaw, double
 }
 
 
-char *read_line(char *string, FILE *infile, int *linenumber) {
+inline char *read_line(char *string, FILE *infile, int *linenumber) {
     char *result;
 
     // Search for a non-empty line.
@@ -59,7 +64,7 @@ char *read_line(char *string, FILE *infile, int *linenumber) {
     return result;
 }
 
-bool isPointInsideTriangle(base_type::Triangle3d tri, base_type::Vector3 p) {
+inline bool isPointInsideTriangle(base_type::Triangle3d tri, base_type::Vector3 p) {
     using namespace Geometrical_Predicates;
 
     if (tri.p1 == p || tri.p2 == p || tri.p3 == p)
@@ -85,7 +90,7 @@ bool isPointInsideTriangle(base_type::Triangle3d tri, base_type::Vector3 p) {
 
 }
 
-Geometrical_Predicates::IntersectionResult3d RayIntersectionCalulate_Triangle(base_type::Triangle3d tri, base_type::Ray3d ray, bool include_border) {
+inline Geometrical_Predicates::IntersectionResult3d RayIntersectionCalulate_Triangle(base_type::Triangle3d tri, base_type::Ray3d ray, bool include_border) {
     using namespace Geometrical_Predicates;
 
     auto ray_dir = (ray.to - ray.from);
@@ -139,479 +144,333 @@ Geometrical_Predicates::IntersectionResult3d RayIntersectionCalulate_Triangle(ba
 }
 
 
+//The distinct vertices of faces (indices into surface) in increasing order, and the faces as local indices into them.
+//The face corners are radix sorted by vertex, so time and memory follow the number of faces, not the mesh size.
+inline void number_face_vertices(const base_type::Boundary_Surface &surface, const std::vector<int> &faces,
+                                 std::vector<uint32_t> &vtx_array, std::vector<int> &connectivity) {
+    struct Corner {
+        uint32_t vertex;
+        uint32_t slot; //face position * 3 + k
+    };
+
+    std::vector<Corner> corner(faces.size() * 3);
+    for (size_t j = 0; j < faces.size(); j++) {
+        for (int k = 0; k < 3; k++)
+            corner[j * 3 + k] = {surface.face_vertex[faces[j] * 3 + k], uint32_t(j * 3 + k)};
+    }
+    radix_sort(corner, 2, [](const Corner &c, int d) -> uint32_t {
+        return (c.vertex >> (d * 16)) & 0xffff;
+    });
+
+    vtx_array.clear();
+    connectivity.resize(corner.size());
+    for (size_t i = 0; i < corner.size(); i++) {
+        if (i == 0 || corner[i].vertex != corner[i - 1].vertex)
+            vtx_array.push_back(corner[i].vertex);
+        connectivity[corner[i].slot] = vtx_array.size() - 1;
+    }
+}
+
+//faces are indices into Unwrap::surface
 struct PhysicalGroup_2D {
-    std::vector<Face *> face_array;
-    std::vector<Face *> boundary_face_array;
+    std::vector<int> face_array;
 
 
-    std::vector<Vertex *> get_vtx() {
-        std::vector<Vertex *> vtx_array;
-        for (const auto &f: face_array) {
-            if (std::find(vtx_array.begin(), vtx_array.end(), f->p1) == vtx_array.end()) {
-                vtx_array.push_back(f->p1);
-            }
-            if (std::find(vtx_array.begin(), vtx_array.end(), f->p2) == vtx_array.end()) {
-                vtx_array.push_back(f->p2);
-            }
-            if (std::find(vtx_array.begin(), vtx_array.end(), f->p3) == vtx_array.end()) {
-                vtx_array.push_back(f->p3);
-            }
-        }
-        return vtx_array;
+    void local_numbering(const base_type::Boundary_Surface &surface, std::vector<uint32_t> &vtx_array, std::vector<int> &connectivity) const {
+        number_face_vertices(surface, face_array, vtx_array, connectivity);
     }
 };
 
 struct Unwrap {
-    MemoryPool vertex_pool;
-    MemoryPool edge_pool;
-    MemoryPool face_pool;
-    MemoryPool tetrahedra_pool;
+    base_type::Compact_Tet_Mesh mesh;
+    base_type::Boundary_Surface surface;
+    BVH surface_bvh;
+    Geometrical_Predicates::Triangle_Batch surface_batch; //boundary triangles in surface_bvh.primitive order
 
     int size = 40;
     std::vector<PhysicalGroup_2D> phy_group_array;
+    std::vector<int> tet_cell_index;
+    bool has_material = false; //mesh.tet_type holds the MaterialIDs of set_tet_type
+    base_type::Vector3 center; //mean of the mesh points, the rays of Unwrap_01 start here
 
-    Unwrap() {
-        vertex_pool.initializePool(sizeof(base_type::Vertex), 1000 * 1.2, 8, 32);
-        tetrahedra_pool.initializePool(sizeof(base_type::Tetrahedra), 1000 * 3 * 1.2, 8, 32);
-        face_pool.initializePool(sizeof(base_type::Face), 1000 * 1.2, 8, 32);
-        edge_pool.initializePool(sizeof(base_type::Edge), 1000 * 3 * 1.2, 8, 32);
-
-    }
-
-    bool init_from_filedata(Mesh_Loader::FileData data) {
-
-
+    //triangle cells are skipped, tet_cell_index maps tet index -> cell index in data
+    bool init_from_filedata(const Mesh_Loader::FileData &data) {
+        mesh.reserve(data.numberOfPoints, data.numberOfCell);
         for (int i = 0; i < data.numberOfPoints; i++) {
-            base_type::Vertex::allocate_from_pool(&vertex_pool, {data.pointList[i * 3], data.pointList[i * 3 + 1], data.pointList[i * 3 + 2]});
+            mesh.position.emplace_back(data.pointList[i * 3], data.pointList[i * 3 + 1], data.pointList[i * 3 + 2]);
         }
+        tet_cell_index.clear();
         for (int i = 0; i < data.numberOfCell; i++) {
             auto &cell = data.cellList[i];
-            assert(cell.numberOfPoints == 4);
-            base_type::Vertex *p1 = (base_type::Vertex *) vertex_pool[cell.pointList[0]];
-            base_type::Vertex *p2 = (base_type::Vertex *) vertex_pool[cell.pointList[1]];
-            base_type::Vertex *p3 = (base_type::Vertex *) vertex_pool[cell.pointList[2]];
-            base_type::Vertex *p4 = (base_type::Vertex *) vertex_pool[cell.pointList[3]];
-            auto t = base_type::Tetrahedra::allocate_from_pool(&tetrahedra_pool, p1, p2, p3, p4);
-            if (config.array_to_number) {
-                if (config.export_materialids_using_slot < data.cellDataInt.size()) {
-                    auto iter = data.cellDataInt.begin();
-                    std::advance(iter, config.export_materialids_using_slot);
-                    t->type_id = iter->second.content[i];
-                }
-                else
-                    t->type_id = data.cellDataInt.begin()->second.content[i];
-            }
+            if (cell.numberOfPoints != 4)
+                continue;
+            mesh.add_tet(cell.pointList[0], cell.pointList[1], cell.pointList[2], cell.pointList[3], 0);
+            tet_cell_index.push_back(i);
+        }
+        center = base_type::Vector3(0, 0, 0);
+        for (const auto &position: mesh.position) {
+            center += position / mesh.vertex_number();
+        }
+        //only the boundary is unwrapped, interior faces and tet neighbors are not needed
+        surface.build_boundary_only(mesh);
 
+        std::vector<base_type::Triangle3d> triangles(surface.face_number());
+        for (int f = 0; f < triangles.size(); f++) {
+            triangles[f] = get_face_triangle(f);
+        }
+        surface_bvh.build(triangles);
+        surface_batch.clear();
+        surface_batch.reserve(triangles.size());
+        for (auto f: surface_bvh.primitive) {
+            surface_batch.push_back(triangles[f]);
         }
-        update_tet_neightbors();
-        create_face_and_edge();
-        boundary_face_mark();
         return true;
     }
 
-    bool save_file(std::string path_base) {
-        using namespace Mesh_Loader;
-        {
-            FileData data;
-
-            data.numberOfPoints = vertex_pool.size();
-            data.pointList = new double[data.numberOfPoints * 3];
-
-            for (int j = 0; j < vertex_pool.size(); j++) {
-                const auto &vtx = (Vertex *) vertex_pool[j];
-                data.pointList[j * 3] = vtx->position.x;
-                data.pointList[j * 3 + 1] = vtx->position.y;
-                data.pointList[j * 3 + 2] = vtx->position.z;
-
-            }
-            if (config.array_to_number)
-                data.cellDataInt["MaterialIDs"];
-            data.numberOfCell = tetrahedra_pool.size();
-            data.cellList = new Cell[data.numberOfCell];
-            for (int j = 0; j < tetrahedra_pool.size(); j++) {
-                const auto &t = (Tetrahedra *) tetrahedra_pool[j];
-                data.cellList[j].pointList = new int[4];
-                data.cellList[j].numberOfPoints = 4;
-                if (config.array_to_number)
-                    data.cellDataInt["MaterialIDs"].content.push_back(t->type_id);
-                data.cellList[j].pointList[0] = t->p1->static_index;
-                data.cellList[j].pointList[1] = t->p2->static_index;
-                data.cellList[j].pointList[2] = t->p3->static_index;
-                data.cellList[j].pointList[3] = t->p4->static_index;
+    //group id of every tet in the ZGROUP slot (same indexing and ids as the exodus blocks), -1 ungrouped;
+    //the patches get it as MaterialIDs of their bulk cells. False (no MaterialIDs) if data has no group array
+    bool set_tet_type(const Mesh_Loader::FileData &data, int slot) {
+        std::vector<int> ids;
+        std::vector<std::string> names;
+        has_material = Mesh_Loader::get_cell_group_ids(data, slot, ids, names);
+        for (size_t t = 0; t < mesh.tet_number(); t++)
+            mesh.tet_type[t] = has_material ? ids[tet_cell_index[t]] : 0;
+        return has_material;
+    }
 
-            }
-            save_vtu((path_base + "/" + "domain" + ".vtu").c_str(), data);
+    //the volume mesh is the <name>.vtu written by main, only the surfaces are written here;
+    //bulk_element_ids index the cells of that file. Each patch is built and written by its own task on pool,
+    //wait on pool before this Unwrap is changed or destroyed
+    void save_file(std::string path_base, Task_Pool &pool) const {
+        if (config.merge_boundary_surfaces) {
+            pool.submit([this, path_base](int) {
+                save_merged_file(path_base);
+            });
+            return;
         }
 
-
         for (int i = 0; i < phy_group_array.size(); i++) {
-            auto &phg = phy_group_array[i];
-            auto phg_vtx_array = phg.get_vtx();
-            FileData data;
-
-            data.numberOfPoints = phg_vtx_array.size();
-            data.pointList = new double[data.numberOfPoints * 3];
-
-
-            data.pointDataUInt64["bulk_node_ids"];
-            data.cellDataUInt64["bulk_element_ids"];
-
-            for (int j = 0; j < phg_vtx_array.size(); j++) {
-                const auto &vtx = phg_vtx_array[j];
-                data.pointList[j * 3] = vtx->position.x;
-                data.pointList[j * 3 + 1] = vtx->position.y;
-                data.pointList[j * 3 + 2] = vtx->position.z;
-                data.pointDataUInt64["bulk_node_ids"].content.push_back(vtx->static_index);
-            }
-
-            data.numberOfCell = phg.face_array.size();
-            data.cellList = new Cell[data.numberOfCell];
-
-            for (int j = 0; j < phg.face_array.size(); j++) {
-                const auto &face = phg.face_array[j];
-                data.cellList[j].pointList = new int[3];
-                data.cellList[j].numberOfPoints = 3;
-
-                //data.cellList[j].cellattr = new double[1];
-                auto it = std::find(phg_vtx_array.begin(), phg_vtx_array.end(), face->p1);
-                assert(it != phg_vtx_array.end());
-
-                data.cellList[j].pointList[0] = std::distance(phg_vtx_array.begin(), it);
-                it = std::find(phg_vtx_array.begin(), phg_vtx_array.end(), face->p2);
-                assert(it != phg_vtx_array.end());
-                data.cellList[j].pointList[1] = std::distance(phg_vtx_array.begin(), it);
-                it = std::find(phg_vtx_array.begin(), phg_vtx_array.end(), face->p3);
-                assert(it != phg_vtx_array.end());
-                data.cellList[j].pointList[2] = std::distance(phg_vtx_array.begin(), it);
-
-                data.cellDataUInt64["bulk_element_ids"].content.push_back(face->disjoin_tet[0] != nullptr ? face->disjoin_tet[0]->static_index : face->disjoin_tet[1]->static_index);
-            }
-            save_vtu((path_base + "/" + std::to_string(i) + ".vtu").c_str(), data);
-            //data.free_self();
+            pool.submit([this, path_base, i](int) {
+                Mesh_Loader::FileData data;
+                get_patch_data(i, data);
+                Mesh_Loader::save_vtu((path_base + "/" + std::to_string(i) + ".vtu").c_str(), data);
+                //data.free_self();
+            });
         }
-        return true;
     }
 
-    void update_tet_neightbors() {
+    //points, triangles, bulk_node_ids, bulk_element_ids (and MaterialIDs) of patch i, points in bulk order
+    void get_patch_data(int i, Mesh_Loader::FileData &data) const {
+        using namespace Mesh_Loader;
 
-        for (int i = 0; i < tetrahedra_pool.size(); i++) {
-            for (int j = 0; j < 4; j++) {
-                auto t1 = (Tetrahedra *) tetrahedra_pool[i];
-                t1->neighbors[j] = nullptr;
-            }
+        const auto &phg = phy_group_array[i];
+        std::vector<uint32_t> vtx_array;
+        std::vector<int> connectivity;
+        phg.local_numbering(surface, vtx_array, connectivity);
+
+        data.numberOfPoints = vtx_array.size();
+        data.pointList = new double[data.numberOfPoints * 3];
+        auto &bulk_node_ids = data.pointDataUInt64["bulk_node_ids"].content;
+        bulk_node_ids.resize(vtx_array.size());
+        for (int j = 0; j < vtx_array.size(); j++) {
+            const auto &position = mesh.position[vtx_array[j]];
+            data.pointList[j * 3] = position.x;
+            data.pointList[j * 3 + 1] = position.y;
+            data.pointList[j * 3 + 2] = position.z;
+            bulk_node_ids[j] = vtx_array[j];
         }
 
-        for (int i = 0; i < tetrahedra_pool.size(); i++) {
-            auto t1 = (Tetrahedra *) tetrahedra_pool[i];
+        data.numberOfCell = phg.face_array.size();
+        data.cellList = new Cell[data.numberOfCell];
+        int *cell_point = new int[connectivity.size()];
+        std::copy(connectivity.begin(), connectivity.end(), cell_point);
+        auto &bulk_element_ids = data.cellDataUInt64["bulk_element_ids"].content;
+        bulk_element_ids.resize(phg.face_array.size());
+        for (int j = 0; j < phg.face_array.size(); j++) {
+            data.cellList[j].numberOfPoints = 3;
+            data.cellList[j].pointList = cell_point + j * 3;
+            bulk_element_ids[j] = tet_cell_index[surface.half_face[phg.face_array[j]] / 4];
+        }
+        if (has_material) {
+            auto &material = data.cellDataInt["MaterialIDs"].content;
+            material.resize(phg.face_array.size());
+            for (int j = 0; j < phg.face_array.size(); j++)
+                material[j] = mesh.tet_type[surface.half_face[phg.face_array[j]] / 4];
+        }
+    }
 
-            for (int j = 0; j < 4; j++) {
-                auto vtx = t1->get_vtx(j);
-                for (auto t2: *vtx->connect_tetrahedra_array) {
-                    if (t1 == t2)
-                        continue;
+    //all patches in one boundary.vtu: shared points, int patch_id (and MaterialIDs) per cell, 32 bit bulk ids
+    bool save_merged_file(std::string path_base) const {
+        using namespace Mesh_Loader;
 
-                    if (Tetrahedra::is_tetrahedra_disjoin(t1, t2)) {
-                        //mark t1 t2 as neighbor
-                        int k = Tetrahedra::find_disjoin_tet_non_share_vtx_index_in_t2(t1, t2);
-                        t2->neighbors[k] = t1;
+        std::vector<int> faces;
+        for (auto &phg: phy_group_array)
+            faces.insert(faces.end(), phg.face_array.begin(), phg.face_array.end());
+        const int face_number = faces.size();
+        std::vector<uint32_t> vtx_array;
+        std::vector<int> local_connectivity;
+        number_face_vertices(surface, faces, vtx_array, local_connectivity);
+
+        FileData data;
+        data.numberOfPoints = vtx_array.size();
+        data.pointList = new double[data.numberOfPoints * 3];
+        auto &bulk_node_ids = data.pointDataUInt["bulk_node_ids"].content;
+        bulk_node_ids.resize(vtx_array.size());
+        for (int j = 0; j < vtx_array.size(); j++) {
+            data.pointList[j * 3] = mesh.position[vtx_array[j]].x;
+            data.pointList[j * 3 + 1] = mesh.position[vtx_array[j]].y;
+            data.pointList[j * 3 + 2] = mesh.position[vtx_array[j]].z;
+            bulk_node_ids[j] = vtx_array[j];
+        }
 
-                        k = Tetrahedra::find_disjoin_tet_non_share_vtx_index_in_t2(t2, t1);
-                        t1->neighbors[k] = t2;
-                    }
-                }
+        data.numberOfCell = face_number;
+        data.cellList = new Cell[face_number];
+        int *connectivity = new int[face_number * 3];
+        std::copy(local_connectivity.begin(), local_connectivity.end(), connectivity);
+        auto &patch_id = data.cellDataInt["patch_id"].content;
+        auto &bulk_element_ids = data.cellDataUInt["bulk_element_ids"].content;
+        patch_id.reserve(face_number);
+        bulk_element_ids.reserve(face_number);
+        int j = 0;
+        for (int i = 0; i < phy_group_array.size(); i++) {
+            for (const auto &face: phy_group_array[i].face_array) {
+                data.cellList[j].numberOfPoints = 3;
+                data.cellList[j].pointList = connectivity + j * 3;
+                patch_id.push_back(i);
+                bulk_element_ids.push_back(tet_cell_index[surface.half_face[face] / 4]);
+                j++;
             }
-
-
         }
+        if (has_material) {
+            auto &material = data.cellDataInt["MaterialIDs"].content;
+            material.reserve(face_number);
+            for (const auto &phg: phy_group_array) {
+                for (const auto &face: phg.face_array)
+                    material.push_back(mesh.tet_type[surface.half_face[face] / 4]);
+            }
+        }
+        return save_vtu((path_base + "/" + "boundary" + ".vtu").c_str(), data);
     }
 
-    void create_face_and_edge() {
-
-
-        for (int i = 0; i < tetrahedra_pool.size(); i++) {
-
-            auto create_tet_face = [this](int tet_face_index, Tetrahedra *t) {
-                if (t->faces[tet_face_index] == nullptr) {
-                    if (t->neighbors[tet_face_index] != nullptr) {
-                        //find adjface_vtx_index
-                        auto face_index = Tetrahedra::find_disjoin_tet_non_share_vtx_index_in_t2(t, t->neighbors[tet_face_index]);
-                        auto face_in_neighbor = t->neighbors[tet_face_index]->faces[face_index];
-                        if (face_in_neighbor != nullptr) {
-                            Tetrahedra::bind_tet_and_face(t, face_in_neighbor);
-                            return;
-                        }
-                    }
-
-                    auto f = Face::allocate_from_pool(&face_pool);
-                    if (tet_face_index == 0) {
-                        f->p1 = t->p2;
-                        f->p2 = t->p3;
-                        f->p3 = t->p4;
-                    }
-                    else if (tet_face_index == 1) {
-                        f->p1 = t->p1;
-                        f->p2 = t->p3;
-                        f->p3 = t->p4;
-                    }
-                    else if (tet_face_index == 2) {
-                        f->p1 = t->p1;
-                        f->p2 = t->p2;
-                        f->p3 = t->p4;
-                    }
-                    else if (tet_face_index == 3) {
-                        f->p1 = t->p1;
-                        f->p2 = t->p2;
-                        f->p3 = t->p3;
-                    }
-                    else {
-                        assert(false);
-                    }
-                    Tetrahedra::bind_tet_and_face(t, f);
-                }
-            };
-
-            auto t = (Tetrahedra *) tetrahedra_pool[i];
-
-            //create face
-            create_tet_face(0, t);
-            create_tet_face(1, t);
-            create_tet_face(2, t);
-            create_tet_face(3, t);
-
-            for (int j = 0; j < 4; j++) {
-                auto f = t->faces[j];
-
-                auto p1 = (Vertex *) f->p1;
-                auto p2 = (Vertex *) f->p2;
-                auto p3 = (Vertex *) f->p3;
-
-                auto find_edge = [](Vertex *p1, Vertex *p2, base_type::Edge *&res) -> bool {
-
-                    for (auto e: *p1->connect_edge_array) {
-                        if (e->orig == p2 || e->end == p2) {
-                            res = e;
-                            return true;
-                        }
-                    }
-
-                    for (auto e: *p2->connect_edge_array) {
-                        if (e->orig == p1 || e->end == p1) {
-                            res = e;
-                            return true;
-                        }
-                    }
-
-                    return false;
-                };
-
-                base_type::Edge *e = nullptr;
-                if (!find_edge(p1, p2, e)) {
-                    e = base_type::Edge::allocate_from_pool(&edge_pool, p1, p2);
-                }
-                f->disjoin_edge[0] = e;
-                e->connect_face_array->push_back(f);
-                if (!find_edge(p2, p3, e)) {
-                    e = base_type::Edge::allocate_from_pool(&edge_pool, p2, p3);
-                }
-                f->disjoin_edge[1] = e;
-                e->connect_face_array->push_back(f);
-                if (!find_edge(p3, p1, e)) {
-                    e = base_type::Edge::allocate_from_pool(&edge_pool, p3, p1);
-                }
-                f->disjoin_edge[2] = e;
-                e->connect_face_array->push_back(f);
+    std::vector<Mesh_Loader::FaceGroup> get_face_groups() {
+        static const char *direction_name[6] = {"x+", "x-", "y+", "y-", "z+", "z-"};
+        std::vector<Mesh_Loader::FaceGroup> res(phy_group_array.size());
+        for (int i = 0; i < phy_group_array.size(); i++) {
+            res[i].name = std::string("surface_") + (i < 6 ? direction_name[i] : std::to_string(i).c_str());
+            for (const auto &face: phy_group_array[i].face_array) {
+                res[i].pointList.push_back(surface.face_vertex[face * 3]);
+                res[i].pointList.push_back(surface.face_vertex[face * 3 + 1]);
+                res[i].pointList.push_back(surface.face_vertex[face * 3 + 2]);
             }
-
         }
+        return res;
     }
 
-    void boundary_face_mark() {
+    base_type::Triangle3d get_face_triangle(int f) const {
+        return {mesh.position[surface.face_vertex[f * 3]], mesh.position[surface.face_vertex[f * 3 + 1]], mesh.position[surface.face_vertex[f * 3 + 2]]};
+    }
 
-        int boundary_face_num = 0;
-        for (int i = 0; i < face_pool.size(); i++) {
-            auto f = (Face *) face_pool[i];
+    //the boundary face closest to ray.from hit by the segment ray.from -> ray.to, or -1
+    int probe(const base_type::Ray3d &ray, bool include_border = false) const {
+        return surface_bvh.nearest_hit_range(ray.from, ray.to, [&](uint32_t begin, uint32_t end, double &t) {
+            return Geometrical_Predicates::nearest_segment_hit(surface_batch, begin, end, ray, include_border, &t);
+        });
+    }
 
-            if (f->disjoin_tet[0] == nullptr || f->disjoin_tet[1] == nullptr) {
-                f->is_boundary_face = true;
-                boundary_face_num++;
+    //Patches of the boundary in one parallel pass. side[f] is the direction closest to the outward normal of face f,
+    //or -1 when even that one is limit (cosine) or further away. The direction of a side is the reference normal of
+    //all its patches: since union-find merges transitively, comparing neighbors with each other would let a curved
+    //surface chain around the mesh, so every face of a patch is within limit of its axis instead.
+    //Faces sharing an edge are merged when they have the same side. Returns the patch of every face as the smallest
+    //face index in it.
+    std::vector<int> segment_boundary(const base_type::Vector3 direction[6], double limit, std::vector<int> &side) const {
+        const size_t face_number = surface.face_number();
+        side.resize(face_number);
+        parallel_for(face_number, [&](size_t f) {
+            auto n = surface.normal(f);
+            int best = 0;
+            for (int d = 1; d < 6; d++) {
+                if (Geometrical_Predicates::dot(n, direction[d]) > Geometrical_Predicates::dot(n, direction[best]))
+                    best = d;
             }
-            else {
-                f->is_boundary_face = false;
+            side[f] = Geometrical_Predicates::dot(n, direction[best]) > limit ? best : -1;
+        });
+
+        Concurrent_Union_Find patch_set(face_number);
+        parallel_for(face_number, [&](size_t f) {
+            for (uint32_t i = surface.dual_offset[f]; i < surface.dual_offset[f + 1]; i++) {
+                uint32_t g = surface.dual_face[i];
+                if (g > f && side[f] >= 0 && side[g] == side[f])
+                    patch_set.unite(f, g);
             }
+        });
 
-        }
-
-
+        std::vector<int> patch(face_number);
+        parallel_for(face_number, [&](size_t f) {
+            patch[f] = patch_set.find(f);
+        });
+        return patch;
     }
 
 
 };
 
 
-void Unwrap_01(Unwrap &uw) {
-
+//rotation is (r_x, r_y, r_z) of the export settings; only the ray seeds and the segmentation are computed here,
+//so one Unwrap can be run for many rotations
+inline void Unwrap_01(Unwrap &uw, const base_type::Vector3 &rotation) {
+    const base_type::Vector3 &center = uw.center;
 
-    //Step 1: Get mesh center
-    base_type::Vector3 center(0, 0, 0);
-    auto uw_vtx_len = uw.vertex_pool.size();
-    for (int i = 0; i < uw.vertex_pool.size(); i++) {
-        auto v = (Vertex *) uw.vertex_pool[i];
-        center += base_type::Vector3(v->position.x / uw_vtx_len, v->position.y / uw_vtx_len, v->position.z / uw_vtx_len);
-    }
-
-    //find six tri
+    //Step 1: find six tri, the first boundary face hit by a ray along each rotated axis
 
-    Face *six_direction_center_face[6] = {nullptr, nullptr, nullptr, nullptr, nullptr, nullptr};//x+-;y+-;z+-
+    int six_direction_center_face[6] = {-1, -1, -1, -1, -1, -1};//x+-;y+-;z+-
     const base_type::Vector3 center_offset{0, 0, 0};
-    const base_type::Vector3 center_rotation{config.r_x, config.r_y, config.r_z};
+    const base_type::Vector3 &center_rotation = rotation;
     const double len = 5000;
     base_type::Vector3 axis_x = Rotate3d({1, 0, 0}, center_rotation.x, center_rotation.y, center_rotation.z);
     base_type::Vector3 axis_y = Rotate3d({0, 1, 0}, center_rotation.x, center_rotation.y, center_rotation.z);
     base_type::Vector3 axis_z = VectorNormal(cross(axis_x, axis_y));
+    const base_type::Vector3 direction[6] = {axis_x, -axis_x, axis_y, -axis_y, axis_z, -axis_z};
 
-    for (int i = 0; i < uw.face_pool.size(); i++) {
-        auto f = (Face *) uw.face_pool[i];
-
-        if (f->is_boundary_face) {
-            auto res0 = RayIntersectionCalulate_Triangle({f->p1->position, f->p2->position, f->p3->position}, {center, center + axis_x * len}, false);
-            if (res0.intersect) {
-                f->draw_read = true;
-                six_direction_center_face[0] = f;
-            }
-
-            auto res1 = RayIntersectionCalulate_Triangle({f->p1->position, f->p2->position, f->p3->position}, {center, center - axis_x * len}, false);
-            if (res1.intersect) {
-                f->draw_read = true;
-                six_direction_center_face[1] = f;
-            }
-
-            auto res2 = RayIntersectionCalulate_Triangle({f->p1->position, f->p2->position, f->p3->position}, {center, center + axis_y * len}, false);
-            if (res2.intersect) {
-                f->draw_read = true;
-                six_direction_center_face[2] = f;
-            }
-
-            auto res3 = RayIntersectionCalulate_Triangle({f->p1->position, f->p2->position, f->p3->position}, {center, center - axis_y * len}, false);
-            if (res3.intersect) {
-                f->draw_read = true;
-                six_direction_center_face[3] = f;
-            }
-
-            auto res4 = RayIntersectionCalulate_Triangle({f->p1->position, f->p2->position, f->p3->position}, {center, center + axis_z * len}, false);
-            if (res4.intersect) {
-                f->draw_read = true;
-                six_direction_center_face[4] = f;
-            }
-
-            auto res5 = RayIntersectionCalulate_Triangle({f->p1->position, f->p2->position, f->p3->position}, {center, center - axis_z * len}, false);
-            if (res5.intersect) {
-                f->draw_read = true;
-                six_direction_center_face[5] = f;
-            }
-
-        }
+    for (int d = 0; d < 6; d++) {
+        six_direction_center_face[d] = uw.probe({center, center + direction[d] * len});
     }
     {
-        assert(six_direction_center_face[0] != nullptr);
-        assert(six_direction_center_face[1] != nullptr);
-        assert(six_direction_center_face[2] != nullptr);
-        assert(six_direction_center_face[3] != nullptr);
-        assert(six_direction_center_face[4] != nullptr);
-        assert(six_direction_center_face[5] != nullptr);
+        assert(six_direction_center_face[0] >= 0);
+        assert(six_direction_center_face[1] >= 0);
+        assert(six_direction_center_face[2] >= 0);
+        assert(six_direction_center_face[3] >= 0);
+        assert(six_direction_center_face[4] >= 0);
+        assert(six_direction_center_face[5] >= 0);
     }
 
-    uw.phy_group_array.push_back({});
-    uw.phy_group_array.push_back({});
-    uw.phy_group_array.push_back({});
-    uw.phy_group_array.push_back({});
-    uw.phy_group_array.push_back({});
-    uw.phy_group_array.push_back({});
-
-    uw.phy_group_array[0].boundary_face_array.push_back(six_direction_center_face[0]);
-    uw.phy_group_array[1].boundary_face_array.push_back(six_direction_center_face[1]);
-    uw.phy_group_array[2].boundary_face_array.push_back(six_direction_center_face[2]);
-    uw.phy_group_array[3].boundary_face_array.push_back(six_direction_center_face[3]);
-    uw.phy_group_array[4].boundary_face_array.push_back(six_direction_center_face[4]);
-    uw.phy_group_array[5].boundary_face_array.push_back(six_direction_center_face[5]);
-
-
-
-    //auto grow
-    auto physicalGroup_2D_grow = [](PhysicalGroup_2D &phy_group) {
-        auto find_boundary_adj_face = [](Face *f, int index) -> Face * {
-            for (auto connect_f: *f->disjoin_edge[index]->connect_face_array) {
-                if (connect_f->is_boundary_face && connect_f != f)
-                    return connect_f;
-            }
-            return nullptr;
-        };
-        auto is_face_grow_able = [](Face *f, Face *face_to_grow) {
-            //assert(Face::is_disjoin_face(f, face_to_grow));
-            auto n1 = Face::get_face_normal(f);
-            auto n2 = Face::get_face_normal(face_to_grow);
-            static const double limit = std::cos(45);
-
-            return fabs(dot(n1, n2)) > limit;
-        };
-
-        if (phy_group.boundary_face_array.size() == 0)
-            return false;
-
-        std::vector<Face *> new_add_face_array;
-
-        bool new_face_added = false;
-        for (auto f: phy_group.boundary_face_array) {
-            auto adj_f0 = find_boundary_adj_face(f, 0);
-            if (adj_f0->mark == false && is_face_grow_able(phy_group.face_array.size() > 0 ? phy_group.face_array[0] : f, adj_f0)) {
-                new_add_face_array.push_back(adj_f0);
-                adj_f0->mark = true;
-                new_face_added = true;
-            }
+    //Step 2: label all patches at once, each side is the patch its ray hits or else the largest one facing that way
+    static const double limit = std::cos(45.0 * M_PI / 180.0);
+    std::vector<int> side;
+    auto patch = uw.segment_boundary(direction, limit, side);
 
-            auto adj_f1 = find_boundary_adj_face(f, 1);
-            if (adj_f1->mark == false && is_face_grow_able(phy_group.face_array.size() > 0 ? phy_group.face_array[0] : f, adj_f1)) {
-                new_add_face_array.push_back(adj_f1);
-                adj_f1->mark = true;
-                new_face_added = true;
-            }
-
-            auto adj_f2 = find_boundary_adj_face(f, 2);
-            if (adj_f2->mark == false && is_face_grow_able(phy_group.face_array.size() > 0 ? phy_group.face_array[0] : f, adj_f2)) {
-                new_add_face_array.push_back(adj_f2);
-                adj_f2->mark = true;
-                new_face_added = true;
-            }
-
-
-        }
-
-        for (auto f: phy_group.boundary_face_array) {
-            phy_group.face_array.push_back(f);
+    const int face_number = uw.surface.face_number();
+    std::vector<double> patch_area(face_number, 0);
+    for (int f = 0; f < face_number; f++) {
+        patch_area[patch[f]] += uw.surface.area[f];
+    }
+    int side_patch[6] = {-1, -1, -1, -1, -1, -1};
+    for (int d = 0; d < 6; d++) {
+        int seed = six_direction_center_face[d];
+        if (seed >= 0 && side[seed] == d) {
+            side_patch[d] = patch[seed];
+            continue;
         }
-        phy_group.boundary_face_array.clear();
-
-        for (auto f: new_add_face_array) {
-            phy_group.boundary_face_array.push_back(f);
+        for (int f = 0; f < face_number; f++) {
+            if (patch[f] == f && side[f] == d && (side_patch[d] < 0 || patch_area[f] > patch_area[side_patch[d]]))
+                side_patch[d] = f;
         }
+    }
 
-        return new_face_added;
-
-    };
-    bool do_next = false;
-    int do_times = 0;
-    do {
-
-        do_next = false;
-        do_next |= physicalGroup_2D_grow(uw.phy_group_array[0]);
-        do_next |= physicalGroup_2D_grow(uw.phy_group_array[1]);
-        do_next |= physicalGroup_2D_grow(uw.phy_group_array[2]);
-        do_next |= physicalGroup_2D_grow(uw.phy_group_array[3]);
-        do_next |= physicalGroup_2D_grow(uw.phy_group_array[4]);
-        do_next |= physicalGroup_2D_grow(uw.phy_group_array[5]);
-        do_times++;
-        //if (do_times == 10)
-        //break;
-
-    } while (do_next);
-
-}
\ No newline at end of file
+    uw.phy_group_array.assign(6, {});
+    for (int f = 0; f < face_number; f++) {
+        int d = side[f];
+        if (d >= 0 && patch[f] == side_patch[d])
+            uw.phy_group_array[d].face_array.push_back(f);
+    }
+}
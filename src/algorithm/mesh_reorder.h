@@ -0,0 +1,376 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <type_traits>
+
+#include "mesh loader/mesh_loader.h"
+#include "basic/data structure/radix_sort.h"
+#include "basic/data structure/csr.h"
+#include "basic/math/vector3.h"
+#include "utils/parallel/parallel.h"
+
+//Renumbering of the points and cells of a FileData. An order lists the old index of every new position;
+//connectivity and every point / cell array of matching length follow it. The first reorder adds uint64 arrays
+//"original_ids" (point and cell) holding the index in the loaded file, later ones permute them like any other array.
+
+template<typename Map>
+void permute_arrays(Map &map, const std::vector<uint32_t> &order) {
+    for (auto &iter: map) {
+        auto &content = iter.second.content;
+        if (content.size() != order.size())
+            continue;
+        std::remove_reference_t<decltype(content)> permuted(order.size());
+        if constexpr (std::is_same_v<std::remove_reference_t<decltype(content)>, std::vector<bool>>) {
+            //packed bits, not safe to write from several threads
+            for (size_t i = 0; i < order.size(); i++)
+                permuted[i] = content[order[i]];
+        }
+        else {
+            parallel_for(order.size(), [&](size_t i) {
+                permuted[i] = std::move(content[order[i]]);
+            });
+        }
+        content.swap(permuted);
+    }
+}
+
+inline void permute_points(Mesh_Loader::FileData &data, const std::vector<uint32_t> &order) {
+    auto &original_ids = data.pointDataUInt64["original_ids"].content;
+    if (original_ids.size() != data.numberOfPoints) {
+        original_ids.resize(data.numberOfPoints);
+        for (size_t i = 0; i < original_ids.size(); i++)
+            original_ids[i] = i;
+    }
+
+    std::vector<uint32_t> new_index(order.size());
+    double *point_list = new double[data.numberOfPoints * 3];
+    parallel_for(order.size(), [&](size_t i) {
+        new_index[order[i]] = i;
+        point_list[i * 3] = data.pointList[order[i] * 3];
+        point_list[i * 3 + 1] = data.pointList[order[i] * 3 + 1];
+        point_list[i * 3 + 2] = data.pointList[order[i] * 3 + 2];
+    });
+    data.pointList = point_list;
+    parallel_for(data.numberOfCell, [&](size_t c) {
+        auto &cell = data.cellList[c];
+        for (int k = 0; k < cell.numberOfPoints; k++)
+            cell.pointList[k] = new_index[cell.pointList[k]];
+    });
+
+    permute_arrays(data.pointDataString, order);
+    permute_arrays(data.pointDataDouble, order);
+    permute_arrays(data.pointDataFloat, order);
+    permute_arrays(data.pointDataInt, order);
+    permute_arrays(data.pointDataUInt, order);
+    permute_arrays(data.pointDataUInt64, order);
+    permute_arrays(data.pointDataBool, order);
+}
+
+inline void permute_cells(Mesh_Loader::FileData &data, const std::vector<uint32_t> &order) {
+    auto &original_ids = data.cellDataUInt64["original_ids"].content;
+    if (original_ids.size() != data.numberOfCell) {
+        original_ids.resize(data.numberOfCell);
+        for (size_t i = 0; i < original_ids.size(); i++)
+            original_ids[i] = i;
+    }
+
+    //cells only own a pointer to their points, so they are moved as they are
+    Mesh_Loader::Cell *cell_list = new Mesh_Loader::Cell[data.numberOfCell];
+    parallel_for(order.size(), [&](size_t i) {
+        cell_list[i] = data.cellList[order[i]];
+    });
+    data.cellList = cell_list;
+
+    permute_arrays(data.cellDataString, order);
+    permute_arrays(data.cellDataDouble, order);
+    permute_arrays(data.cellDataFloat, order);
+    permute_arrays(data.cellDataInt, order);
+    permute_arrays(data.cellDataUInt, order);
+    permute_arrays(data.cellDataUInt64, order);
+    permute_arrays(data.cellDataBool, order);
+}
+
+enum class Space_Filling_Curve {
+    morton,
+    hilbert
+};
+
+//bits per axis of the curve keys, 3 * 21 fit in 64 bit
+const int curve_key_bits = 21;
+
+//bit i of x moves to bit 3 * i
+inline uint64_t spread_bits_3(uint64_t x) {
+    x &= 0x1fffff;
+    x = (x | x << 32) & 0x1f00000000ffff;
+    x = (x | x << 16) & 0x1f0000ff0000ff;
+    x = (x | x << 8) & 0x100f00f00f00f00f;
+    x = (x | x << 4) & 0x10c30c30c30c30c3;
+    x = (x | x << 2) & 0x1249249249249249;
+    return x;
+}
+
+inline uint64_t morton_key(uint32_t x, uint32_t y, uint32_t z) {
+    return spread_bits_3(x) << 2 | spread_bits_3(y) << 1 | spread_bits_3(z);
+}
+
+//Skilling's transform ("Programming the Hilbert curve", 2004): the coordinates are turned into the transposed
+//Hilbert index in place, whose bits are then interleaved like a Morton key
+inline uint64_t hilbert_key(uint32_t x, uint32_t y, uint32_t z) {
+    uint32_t axis[3] = {x, y, z};
+    const uint32_t top = 1u << (curve_key_bits - 1);
+    for (uint32_t q = top; q > 1; q >>= 1) {
+        uint32_t p = q - 1;
+        for (int i = 0; i < 3; i++) {
+            if (axis[i] & q) {
+                axis[0] ^= p;
+            }
+            else {
+                uint32_t t = (axis[0] ^ axis[i]) & p;
+                axis[0] ^= t;
+                axis[i] ^= t;
+            }
+        }
+    }
+    axis[1] ^= axis[0];
+    axis[2] ^= axis[1];
+    uint32_t t = 0;
+    for (uint32_t q = top; q > 1; q >>= 1) {
+        if (axis[2] & q)
+            t ^= q - 1;
+    }
+    for (auto &a: axis)
+        a ^= t;
+    return morton_key(axis[0], axis[1], axis[2]);
+}
+
+//order of the points along the curve through their bounding box, one scale for all axes so the curve is not stretched
+inline std::vector<uint32_t> space_filling_curve_order(const std::vector<base_type::Vector3> &point, Space_Filling_Curve curve) {
+    struct Key {
+        uint64_t key;
+        uint32_t index;
+    };
+
+    std::vector<uint32_t> order(point.size());
+    if (point.empty())
+        return order;
+    base_type::Vector3 low = point[0], high = point[0];
+    for (const auto &p: point) {
+        for (int k = 0; k < 3; k++) {
+            low[k] = std::min(low[k], p[k]);
+            high[k] = std::max(high[k], p[k]);
+        }
+    }
+    const double max_cell = (1u << curve_key_bits) - 1;
+    double extent = std::max(high.x - low.x, std::max(high.y - low.y, high.z - low.z));
+    double scale = extent > 0 ? max_cell / extent : 0;
+
+    std::vector<Key> keys(point.size());
+    parallel_for(point.size(), [&](size_t i) {
+        uint32_t q[3];
+        for (int k = 0; k < 3; k++)
+            q[k] = (uint32_t) std::min(max_cell, std::max(0.0, (point[i][k] - low[k]) * scale));
+        keys[i] = {curve == Space_Filling_Curve::hilbert ? hilbert_key(q[0], q[1], q[2]) : morton_key(q[0], q[1], q[2]), (uint32_t) i};
+    });
+    radix_sort(keys, (3 * curve_key_bits + 15) / 16, [](const Key &key, int d) -> uint32_t {
+        return (key.key >> (d * 16)) & 0xffff;
+    });
+    parallel_for(keys.size(), [&](size_t i) {
+        order[i] = keys[i].index;
+    });
+    return order;
+}
+
+//points by their position, cells by their centroid, along the same curve
+inline void reorder_by_space_filling_curve(Mesh_Loader::FileData &data, Space_Filling_Curve curve) {
+    std::vector<base_type::Vector3> point(data.numberOfPoints);
+    parallel_for(point.size(), [&](size_t i) {
+        point[i] = {data.pointList[i * 3], data.pointList[i * 3 + 1], data.pointList[i * 3 + 2]};
+    });
+    std::vector<base_type::Vector3> centroid(data.numberOfCell);
+    parallel_for(centroid.size(), [&](size_t c) {
+        const auto &cell = data.cellList[c];
+        base_type::Vector3 sum(0, 0, 0);
+        for (int k = 0; k < cell.numberOfPoints; k++)
+            sum += point[cell.pointList[k]];
+        centroid[c] = cell.numberOfPoints > 0 ? sum / cell.numberOfPoints : sum;
+    });
+
+    permute_points(data, space_filling_curve_order(point, curve));
+    permute_cells(data, space_filling_curve_order(centroid, curve));
+}
+
+//points sharing a cell are neighbors, CSR: the neighbors of point i are neighbor[offset[i], offset[i + 1])
+struct Node_Graph {
+    std::vector<uint32_t> offset;
+    std::vector<uint32_t> neighbor;
+
+    uint32_t degree(uint32_t i) const {
+        return offset[i + 1] - offset[i];
+    }
+};
+
+inline Node_Graph build_node_graph(const Mesh_Loader::FileData &data) {
+    const size_t n = data.numberOfPoints;
+
+    //point -> cell incidence
+    CSR_Incidence point_cell;
+    point_cell.build(n, data.numberOfCell, [&](size_t c, auto add) {
+        for (int k = 0; k < data.cellList[c].numberOfPoints; k++)
+            add(data.cellList[c].pointList[k]);
+    });
+
+    //the points of a point's cells, deduplicated with a per-worker stamp array; counted first, then filled
+    Node_Graph graph;
+    graph.offset.assign(n + 1, 0);
+    std::vector<std::vector<uint32_t>> stamp(get_thread_number());
+    auto for_each_neighbor = [&](uint32_t i, std::vector<uint32_t> &seen, auto f) {
+        seen[i] = i;
+        for (auto c = point_cell.row_begin(i); c != point_cell.row_end(i); c++) {
+            const auto &cell = data.cellList[*c];
+            for (int k = 0; k < cell.numberOfPoints; k++) {
+                uint32_t p = cell.pointList[k];
+                if (seen[p] != i) {
+                    seen[p] = i;
+                    f(p);
+                }
+            }
+        }
+    };
+    auto run = [&](auto visit) {
+        parallel_for_chunk(n, 4096, [&](size_t b, size_t e, int worker) {
+            auto &seen = stamp[worker];
+            if (seen.empty())
+                seen.assign(n, UINT32_MAX);
+            for (size_t i = b; i < e; i++)
+                visit(i, seen);
+        });
+    };
+    run([&](uint32_t i, std::vector<uint32_t> &seen) {
+        uint32_t degree = 0;
+        for_each_neighbor(i, seen, [&](uint32_t) { degree++; });
+        graph.offset[i + 1] = degree;
+    });
+    for (size_t i = 0; i < n; i++)
+        graph.offset[i + 1] += graph.offset[i];
+    graph.neighbor.resize(graph.offset[n]);
+    for (auto &seen: stamp)
+        std::fill(seen.begin(), seen.end(), UINT32_MAX);
+    run([&](uint32_t i, std::vector<uint32_t> &seen) {
+        uint32_t *out = &graph.neighbor[graph.offset[i]];
+        for_each_neighbor(i, seen, [&](uint32_t p) { *out++ = p; });
+    });
+    return graph;
+}
+
+//bandwidth: largest |index(i) - index(j)| over neighbors; profile: sum over i of index(i) - the smallest index among i
+//and its neighbors, i.e. the entries of the lower triangle inside the envelope of the matrix
+struct Bandwidth_Profile {
+    uint64_t bandwidth = 0;
+    uint64_t profile = 0;
+};
+
+//new_index empty means the current numbering
+inline Bandwidth_Profile get_bandwidth_profile(const Node_Graph &graph, const std::vector<uint32_t> &new_index = {}) {
+    Bandwidth_Profile res;
+    const size_t n = graph.offset.size() - 1;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t row = new_index.empty() ? i : new_index[i];
+        uint32_t first = row;
+        for (uint32_t j = graph.offset[i]; j < graph.offset[i + 1]; j++) {
+            uint32_t column = new_index.empty() ? graph.neighbor[j] : new_index[graph.neighbor[j]];
+            res.bandwidth = std::max<uint64_t>(res.bandwidth, column > row ? column - row : row - column);
+            first = std::min(first, column);
+        }
+        res.profile += row - first;
+    }
+    return res;
+}
+
+//Reverse Cuthill-McKee, every connected component starts from a pseudo-peripheral node (George and Liu):
+//breadth first from a node, restart from the lowest degree node of the last level while the depth grows.
+//Neighbors are visited by increasing degree, the final order is reversed. Returns new -> old.
+inline std::vector<uint32_t> reverse_cuthill_mckee_order(const Node_Graph &graph) {
+    const uint32_t n = graph.offset.size() - 1;
+    std::vector<uint32_t> order;
+    order.reserve(n);
+    std::vector<bool> placed(n, false);
+
+    //level of each node in the current search, reset after use through the queue
+    std::vector<int> level(n, -1);
+    std::vector<uint32_t> queue;
+    auto breadth_first = [&](uint32_t root) {
+        queue.clear();
+        queue.push_back(root);
+        level[root] = 0;
+        for (size_t head = 0; head < queue.size(); head++) {
+            uint32_t i = queue[head];
+            for (uint32_t j = graph.offset[i]; j < graph.offset[i + 1]; j++) {
+                uint32_t p = graph.neighbor[j];
+                if (level[p] < 0) {
+                    level[p] = level[i] + 1;
+                    queue.push_back(p);
+                }
+            }
+        }
+        int depth = level[queue.back()];
+        uint32_t next = queue.back();
+        for (auto i: queue) {
+            if (level[i] == depth && graph.degree(i) < graph.degree(next))
+                next = i;
+            level[i] = -1;
+        }
+        return std::make_pair(depth, next);
+    };
+
+    std::vector<uint32_t> candidate;
+    for (uint32_t seed = 0; seed < n; seed++) {
+        if (placed[seed])
+            continue;
+        uint32_t root = seed;
+        auto [depth, next] = breadth_first(root);
+        while (true) {
+            auto [next_depth, next_next] = breadth_first(next);
+            if (next_depth <= depth)
+                break;
+            root = next;
+            depth = next_depth;
+            next = next_next;
+        }
+
+        size_t head = order.size();
+        order.push_back(root);
+        placed[root] = true;
+        for (; head < order.size(); head++) {
+            uint32_t i = order[head];
+            candidate.clear();
+            for (uint32_t j = graph.offset[i]; j < graph.offset[i + 1]; j++) {
+                uint32_t p = graph.neighbor[j];
+                if (!placed[p]) {
+                    placed[p] = true;
+                    candidate.push_back(p);
+                }
+            }
+            std::sort(candidate.begin(), candidate.end(), [&](uint32_t a, uint32_t b) {
+                return graph.degree(a) != graph.degree(b) ? graph.degree(a) < graph.degree(b) : a < b;
+            });
+            order.insert(order.end(), candidate.begin(), candidate.end());
+        }
+    }
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+//renumber the points for a small matrix bandwidth, cells keep their order
+inline void reorder_by_reverse_cuthill_mckee(Mesh_Loader::FileData &data, Bandwidth_Profile &before, Bandwidth_Profile &after) {
+    Node_Graph graph = build_node_graph(data);
+    auto order = reverse_cuthill_mckee_order(graph);
+    std::vector<uint32_t> new_index(order.size());
+    for (uint32_t i = 0; i < order.size(); i++)
+        new_index[order[i]] = i;
+    before = get_bandwidth_profile(graph);
+    after = get_bandwidth_profile(graph, new_index);
+    permute_points(data, order);
+}
@@ -0,0 +1,62 @@
+#include "ray_triangle_benchmark.h"
+
+#include <random>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "algorithm/extract_six_surface.h"
+#include "basic/geometrical predicates/ray_triangle_batch.h"
+#include "utils/log/log.h"
+
+void run_ray_triangle_benchmark(int triangle_number, int ray_number) {
+    using namespace Geometrical_Predicates;
+
+    std::mt19937 random(1);
+    std::uniform_real_distribution<double> coord(0, 100), offset(-3, 3);
+    std::vector<Triangle3d> triangles(triangle_number);
+    Triangle_Batch batch;
+    batch.reserve(triangle_number);
+    for (auto &t: triangles) {
+        Vector3 c(coord(random), coord(random), coord(random));
+        t = {c + Vector3(offset(random), offset(random), offset(random)), c + Vector3(offset(random), offset(random), offset(random)),
+             c + Vector3(offset(random), offset(random), offset(random))};
+        batch.push_back(t);
+    }
+    std::vector<Ray3d> rays(ray_number);
+    for (auto &r: rays) {
+        r = {{coord(random), coord(random), coord(random)}, {coord(random), coord(random), coord(random)}};
+    }
+
+    auto report = [&](const std::string &name, double seconds, size_t hits) {
+        char line[256];
+        snprintf(line, sizeof(line), "ray-triangle %-10s %8.2f Mtri/s, %zu hits", name.c_str(),
+                 double(triangle_number) * ray_number / seconds / 1e6, hits);
+        log_print(line);
+    };
+
+    {
+        size_t hits = 0;
+        auto begin = std::chrono::steady_clock::now();
+        for (const auto &r: rays) {
+            for (const auto &t: triangles)
+                hits += RayIntersectionCalulate_Triangle(t, r, false).intersect;
+        }
+        report("reference", std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count(), hits);
+    }
+
+    std::vector<double> t(triangle_number);
+    for (auto kernel: {Ray_Kernel::scalar, Ray_Kernel::avx2, Ray_Kernel::avx512}) {
+        if (kernel > detect_ray_kernel())
+            break;
+        size_t hits = 0;
+        auto begin = std::chrono::steady_clock::now();
+        for (const auto &r: rays) {
+            intersect_segment_batch(batch, 0, batch.size(), r, false, t.data(), kernel);
+            for (double v: t)
+                hits += v <= 1;
+        }
+        report(ray_kernel_name(kernel), std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count(), hits);
+    }
+}
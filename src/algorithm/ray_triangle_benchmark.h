@@ -0,0 +1,5 @@
+#pragma once
+
+//Triangles/second of RayIntersectionCalulate_Triangle against every batch kernel this cpu supports,
+//on random small triangles in a box and random segments across it. Hit counts are logged to compare the rules.
+void run_ray_triangle_benchmark(int triangle_number, int ray_number = 64);
@@ -0,0 +1,265 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include "basic/math/vector3.h"
+#include "basic/geometrical predicates/robust_predicates.h"
+#include "basic/data structure/radix_sort.h"
+#include "basic/data structure/edge_runs.h"
+#include "basic/data structure/csr.h"
+#include "utils/parallel/parallel.h"
+
+namespace base_type {
+
+    //Index based tetrahedral mesh stored as arrays.
+    //A half-face is tet * 4 + k, the face of the tet opposite its local vertex k.
+    //Per tet: 4 vertex indices, 4 neighbor half-faces and a type id (36 bytes).
+    struct Compact_Tet_Mesh {
+        static constexpr uint32_t no_half_face = 0xffffffff;
+
+        std::vector<Vector3> position;
+        std::vector<uint32_t> tet_vertex; //4 per tet
+        std::vector<uint32_t> tet_neighbor; //4 per tet after build_neighbors, the matching half-face of the neighbor or no_half_face
+        std::vector<int> tet_type;
+
+        size_t vertex_number() const {
+            return position.size();
+        }
+
+        size_t tet_number() const {
+            return tet_type.size();
+        }
+
+        void reserve(size_t vertex_capacity, size_t tet_capacity) {
+            position.reserve(vertex_capacity);
+            tet_vertex.reserve(tet_capacity * 4);
+            tet_type.reserve(tet_capacity);
+        }
+
+        uint32_t add_tet(uint32_t v0, uint32_t v1, uint32_t v2, uint32_t v3, int type_id) {
+            tet_vertex.insert(tet_vertex.end(), {v0, v1, v2, v3});
+            tet_type.push_back(type_id);
+            return tet_type.size() - 1;
+        }
+
+        //the other three vertices in increasing local order, the order the pointer mesh gave its faces
+        void half_face_vertex(uint32_t half_face, uint32_t v[3]) const {
+            const uint32_t *vtx = &tet_vertex[half_face & ~3u];
+            int m = 0;
+            for (int j = 0; j < 4; j++) {
+                if (j != (half_face & 3))
+                    v[m++] = vtx[j];
+            }
+        }
+
+        //size of the bounding box of the points
+        Vector3 extent() const {
+            if (position.empty())
+                return {0, 0, 0};
+            Vector3 low = position[0], high = position[0];
+            for (const auto &p: position) {
+                for (int k = 0; k < 3; k++) {
+                    low[k] = std::min(low[k], p[k]);
+                    high[k] = std::max(high[k], p[k]);
+                }
+            }
+            return high - low;
+        }
+
+        //bits per vertex index for packed radix keys
+        int index_bits() const {
+            int bits = 1;
+            while (bits < 32 && (vertex_number() - 1) >> bits)
+                bits++;
+            return bits;
+        }
+
+        //faces are matched by their sorted vertex triple packed into a 3 * index_bits() key and radix sorted;
+        //a face is shared by at most two tets in a valid mesh, extra copies of a non-manifold face are left unmatched
+        void build_neighbors() {
+            struct Face_Key {
+                uint64_t low;
+                uint32_t high;
+                uint32_t half_face;
+            };
+
+            const int bits = index_bits();
+            tet_neighbor.assign(tet_vertex.size(), no_half_face);
+            std::vector<Face_Key> keys(tet_vertex.size());
+            parallel_for(keys.size(), [&](size_t h) {
+                uint32_t v[3];
+                half_face_vertex(h, v);
+                if (v[0] > v[1]) std::swap(v[0], v[1]);
+                if (v[1] > v[2]) std::swap(v[1], v[2]);
+                if (v[0] > v[1]) std::swap(v[0], v[1]);
+                Face_Key &key = keys[h];
+                key.low = v[2] | (uint64_t) v[1] << bits;
+                if (2 * bits < 64) {
+                    key.low |= (uint64_t) v[0] << 2 * bits;
+                    key.high = 3 * bits > 64 ? v[0] >> (64 - 2 * bits) : 0;
+                } else {
+                    key.high = v[0];
+                }
+                key.half_face = h;
+            });
+            radix_sort(keys, (3 * bits + 15) / 16, [](const Face_Key &key, int d) -> uint32_t {
+                return d < 4 ? (key.low >> (d * 16)) & 0xffff : (key.high >> ((d - 4) * 16)) & 0xffff;
+            });
+
+            auto same_face = [](const Face_Key &a, const Face_Key &b) {
+                return a.low == b.low && a.high == b.high;
+            };
+            parallel_for(keys.size() - std::min<size_t>(keys.size(), 1), [&](size_t i) {
+                if (!same_face(keys[i], keys[i + 1]))
+                    return;
+                if ((i > 0 && same_face(keys[i - 1], keys[i])) || (i + 2 < keys.size() && same_face(keys[i + 1], keys[i + 2])))
+                    return;
+                tet_neighbor[keys[i].half_face] = keys[i + 1].half_face;
+                tet_neighbor[keys[i + 1].half_face] = keys[i].half_face;
+            });
+        }
+
+    };
+
+    //The unmatched half-faces of a Compact_Tet_Mesh in half-face order, with outward unit normals and areas
+    //stored per component, and the dual graph (faces sharing an edge) in CSR:
+    //the neighbors of face f are dual_face[dual_offset[f], dual_offset[f + 1]).
+    struct Boundary_Surface {
+        std::vector<uint32_t> half_face;
+        std::vector<uint32_t> face_vertex; //3 per face
+        std::vector<double> normal_x, normal_y, normal_z;
+        std::vector<double> area;
+        std::vector<uint32_t> dual_offset;
+        std::vector<uint32_t> dual_face;
+
+        size_t face_number() const {
+            return half_face.size();
+        }
+
+        //half-faces are bucketed by their smallest vertex and a face is kept when its other two vertices occur once
+        //in the bucket, so interior faces are never stored; every copy of a face shared by more than two tets is dropped.
+        void build_boundary_only(const Compact_Tet_Mesh &mesh) {
+            const size_t half_face_number = mesh.tet_vertex.size();
+            auto sorted_vertex = [&mesh](uint32_t h, uint32_t v[3]) {
+                mesh.half_face_vertex(h, v);
+                if (v[0] > v[1]) std::swap(v[0], v[1]);
+                if (v[1] > v[2]) std::swap(v[1], v[2]);
+                if (v[0] > v[1]) std::swap(v[0], v[1]);
+            };
+
+            CSR_Incidence bucket;
+            bucket.build(mesh.vertex_number(), half_face_number, [&](size_t h, auto add) {
+                uint32_t v[3];
+                sorted_vertex(h, v);
+                add(v[0]);
+            });
+
+            std::vector<std::vector<uint32_t>> worker_face(get_thread_number());
+            parallel_for_chunk(mesh.vertex_number(), 4096, [&](size_t begin, size_t end, int worker_index) {
+                std::vector<std::pair<uint64_t, uint32_t>> rest; //(v[1], v[2]) -> half-face
+                for (size_t vtx = begin; vtx < end; vtx++) {
+                    rest.clear();
+                    for (auto h = bucket.row_begin(vtx); h != bucket.row_end(vtx); h++) {
+                        uint32_t v[3];
+                        sorted_vertex(*h, v);
+                        rest.emplace_back((uint64_t) v[1] << 32 | v[2], *h);
+                    }
+                    std::sort(rest.begin(), rest.end());
+                    for (size_t b = 0, e; b < rest.size(); b = e) {
+                        for (e = b + 1; e < rest.size() && rest[e].first == rest[b].first; e++);
+                        if (e - b == 1)
+                            worker_face[worker_index].push_back(rest[b].second);
+                    }
+                }
+            });
+
+            half_face.clear();
+            for (auto &faces: worker_face)
+                half_face.insert(half_face.end(), faces.begin(), faces.end());
+            std::sort(half_face.begin(), half_face.end());
+            build_faces(mesh);
+        }
+
+        Vector3 normal(size_t f) const {
+            return {normal_x[f], normal_y[f], normal_z[f]};
+        }
+
+    private:
+        void build_faces(const Compact_Tet_Mesh &mesh) {
+            face_vertex.resize(half_face.size() * 3);
+            parallel_for(half_face.size(), [&](size_t f) {
+                mesh.half_face_vertex(half_face[f], &face_vertex[f * 3]);
+            });
+            build_normals(mesh);
+            build_dual_graph(mesh.vertex_number());
+        }
+
+        //face vertex order follows the tet, so the normal is flipped away from the tet's opposite vertex;
+        //which side that vertex is on is decided by the exact orient3d, flat tets and far-off coordinates included
+        void build_normals(const Compact_Tet_Mesh &mesh) {
+            static const size_t chunk_size = 256;
+            size_t n = half_face.size();
+            normal_x.resize(n);
+            normal_y.resize(n);
+            normal_z.resize(n);
+            area.resize(n);
+            const Geometrical_Predicates::Orient3d_Filter filter(mesh.extent());
+            parallel_for_chunk(n, chunk_size, [&](size_t b, size_t e, int) {
+                Vector3 p1[chunk_size], p2[chunk_size], p3[chunk_size], inside[chunk_size];
+                int orient[chunk_size];
+                for (size_t f = b; f < e; f++) {
+                    p1[f - b] = mesh.position[face_vertex[f * 3]];
+                    p2[f - b] = mesh.position[face_vertex[f * 3 + 1]];
+                    p3[f - b] = mesh.position[face_vertex[f * 3 + 2]];
+                    inside[f - b] = mesh.position[mesh.tet_vertex[half_face[f]]];
+                }
+                Geometrical_Predicates::orient3d_sign_batch(filter, p1, p2, p3, inside, e - b, orient);
+
+                for (size_t f = b; f < e; f++) {
+                    auto normal = (p2[f - b] - p1[f - b]).cross(p3[f - b] - p1[f - b]);
+                    double length = std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+                    double scale = length > 0 ? 1 / length : 0;
+                    //orient3d(p1, p2, p3, q) = -(p2 - p1) x (p3 - p1) . (q - p1)
+                    if (orient[f - b] < 0)
+                        scale = -scale;
+                    normal_x[f] = normal.x * scale;
+                    normal_y[f] = normal.y * scale;
+                    normal_z[f] = normal.z * scale;
+                    area[f] = length / 2;
+                }
+            });
+        }
+
+        //every face on an edge is a neighbor of the others on it
+        void build_dual_graph(size_t vertex_number) {
+            Edge_Runs runs;
+            runs.build(face_vertex.size(), vertex_number, [&](size_t i) {
+                return std::make_pair(face_vertex[i], face_vertex[i - i % 3 + (i + 1) % 3]);
+            });
+
+            dual_offset.assign(face_number() + 1, 0);
+            for (size_t r = 0; r < runs.run_number(); r++) {
+                uint32_t b = runs.run_offset[r], e = runs.run_offset[r + 1];
+                for (uint32_t i = b; i < e; i++)
+                    dual_offset[runs.slot[i] / 3 + 1] += e - b - 1;
+            }
+            for (size_t f = 0; f < face_number(); f++)
+                dual_offset[f + 1] += dual_offset[f];
+            dual_face.resize(dual_offset[face_number()]);
+            std::vector<uint32_t> cursor(dual_offset.begin(), dual_offset.end() - 1);
+            for (size_t r = 0; r < runs.run_number(); r++) {
+                uint32_t b = runs.run_offset[r], e = runs.run_offset[r + 1];
+                for (uint32_t i = b; i < e; i++) {
+                    for (uint32_t j = b; j < e; j++) {
+                        if (i != j)
+                            dual_face[cursor[runs.slot[i] / 3]++] = runs.slot[j] / 3;
+                    }
+                }
+            }
+        }
+    };
+
+}
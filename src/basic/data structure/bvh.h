@@ -0,0 +1,291 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <limits>
+
+#include "basic/math/vector3.h"
+#include "basic/geometrical predicates/predicates_wrapper.h"
+
+// Bounding volume hierarchy over triangles, binned SAH build into a flattened depth-first node array.
+// An interior node's left child follows it directly, its right child is at node[i].offset;
+// a leaf covers primitive[offset, offset + count). Primitives are the indices of the triangles passed to build.
+class BVH {
+public:
+    struct Node {
+        double bound_min[3];
+        double bound_max[3];
+        uint32_t offset;
+        uint32_t count; //0 for interior nodes
+    };
+
+    std::vector<Node> node;
+    std::vector<uint32_t> primitive;
+
+    static const int bin_number = 16;
+    //leaves are tested by the batched ray kernels, 8 is one AVX-512 pass (two AVX2 passes) with no scalar tail
+    static const int leaf_size = 8;
+
+    void build(const std::vector<Geometrical_Predicates::Triangle3d> &triangle) {
+        node.clear();
+        primitive.resize(triangle.size());
+        if (triangle.empty())
+            return;
+
+        std::vector<Box> box(triangle.size());
+        for (uint32_t i = 0; i < triangle.size(); i++) {
+            primitive[i] = i;
+            box[i] = Box();
+            box[i].grow(triangle[i].p1);
+            box[i].grow(triangle[i].p2);
+            box[i].grow(triangle[i].p3);
+        }
+
+        struct Task {
+            uint32_t node, begin, end;
+        };
+        node.reserve(2 * triangle.size() / leaf_size + 1);
+        node.push_back({});
+        std::vector<Task> stack = {{0, 0, (uint32_t) triangle.size()}};
+        while (!stack.empty()) {
+            Task task = stack.back();
+            stack.pop_back();
+
+            Box bound, centroid_bound;
+            for (uint32_t i = task.begin; i < task.end; i++) {
+                bound.grow(box[primitive[i]]);
+                centroid_bound.grow(box[primitive[i]].center());
+            }
+            set_bound(node[task.node], bound);
+
+            uint32_t mid = task.end - task.begin > leaf_size ? split(box, centroid_bound, bound, task.begin, task.end) : task.begin;
+            if (mid == task.begin || mid == task.end) {
+                //increasing primitives inside a leaf, so a batched leaf test that prefers the later position on a tie
+                //also prefers the larger primitive
+                std::sort(primitive.begin() + task.begin, primitive.begin() + task.end);
+                node[task.node].offset = task.begin;
+                node[task.node].count = task.end - task.begin;
+                continue;
+            }
+
+            //left child first so it ends up right after its parent
+            uint32_t left = node.size();
+            uint32_t right = left + 1;
+            node.push_back({});
+            node.push_back({});
+            node[task.node].offset = right;
+            node[task.node].count = 0;
+            stack.push_back({right, mid, task.end});
+            stack.push_back({left, task.begin, mid});
+        }
+        reorder_depth_first();
+    }
+
+    // Closest hit of the segment from -> to. test(primitive, t) returns true for a hit at parameter t in [0, 1];
+    // on equal t the larger primitive wins. Returns the primitive or -1, hit_t receives its parameter.
+    template<typename Test>
+    int nearest_hit(const base_type::Vector3 &from, const base_type::Vector3 &to, Test test, double *hit_t = nullptr) const {
+        return nearest_hit_range(from, to, [&](uint32_t begin, uint32_t end, double &leaf_t) {
+            int leaf_best = -1;
+            for (uint32_t i = begin; i < end; i++) {
+                double t;
+                if (test(primitive[i], t) && t >= 0 && t <= 1 &&
+                    (leaf_best < 0 || t < leaf_t || (t == leaf_t && primitive[i] > primitive[leaf_best]))) {
+                    leaf_best = i;
+                    leaf_t = t;
+                }
+            }
+            return leaf_best;
+        }, hit_t);
+    }
+
+    // As nearest_hit, but whole leaves are tested at once: leaf_test(begin, end, t) gets a range of positions in
+    // primitive[] (so data stored in that order can be processed as a batch) and returns the position of its
+    // closest hit with t set, or -1.
+    template<typename Leaf_Test>
+    int nearest_hit_range(const base_type::Vector3 &from, const base_type::Vector3 &to, Leaf_Test leaf_test, double *hit_t = nullptr) const {
+        if (node.empty())
+            return -1;
+
+        double origin[3] = {from.x, from.y, from.z};
+        double inverse_dir[3] = {1 / (to.x - from.x), 1 / (to.y - from.y), 1 / (to.z - from.z)};
+        int best = -1;
+        double best_t = 1;
+
+        std::vector<uint32_t> stack;
+        stack.reserve(64);
+        uint32_t current = 0;
+        while (true) {
+            const Node &n = node[current];
+            if (n.count > 0) {
+                double t;
+                int i = leaf_test(n.offset, n.offset + n.count, t);
+                if (i >= 0 && t >= 0 && t <= 1 && (best < 0 || t < best_t || (t == best_t && primitive[i] > primitive[best]))) {
+                    best = i;
+                    best_t = t;
+                }
+            }
+            else {
+                uint32_t near_child = current + 1, far_child = n.offset;
+                double near_t = entry(node[near_child], origin, inverse_dir);
+                double far_t = entry(node[far_child], origin, inverse_dir);
+                if (far_t < near_t) {
+                    std::swap(near_child, far_child);
+                    std::swap(near_t, far_t);
+                }
+                if (near_t <= best_t) {
+                    if (far_t <= best_t)
+                        stack.push_back(far_child);
+                    current = near_child;
+                    continue;
+                }
+            }
+
+            //entries are re-checked against the best hit found since they were pushed
+            bool found = false;
+            while (!stack.empty()) {
+                current = stack.back();
+                stack.pop_back();
+                if (entry(node[current], origin, inverse_dir) <= best_t) {
+                    found = true;
+                    break;
+                }
+            }
+            if (!found)
+                break;
+        }
+
+        if (hit_t != nullptr)
+            *hit_t = best_t;
+        return best < 0 ? -1 : (int) primitive[best];
+    }
+
+private:
+    struct Box {
+        double min[3] = {std::numeric_limits<double>::max(), std::numeric_limits<double>::max(), std::numeric_limits<double>::max()};
+        double max[3] = {-std::numeric_limits<double>::max(), -std::numeric_limits<double>::max(), -std::numeric_limits<double>::max()};
+
+        void grow(const base_type::Vector3 &p) {
+            for (int k = 0; k < 3; k++) {
+                min[k] = std::min(min[k], p[k]);
+                max[k] = std::max(max[k], p[k]);
+            }
+        }
+
+        void grow(const Box &b) {
+            for (int k = 0; k < 3; k++) {
+                min[k] = std::min(min[k], b.min[k]);
+                max[k] = std::max(max[k], b.max[k]);
+            }
+        }
+
+        base_type::Vector3 center() const {
+            return {(min[0] + max[0]) / 2, (min[1] + max[1]) / 2, (min[2] + max[2]) / 2};
+        }
+
+        double half_area() const {
+            if (min[0] > max[0])
+                return 0;
+            double dx = max[0] - min[0], dy = max[1] - min[1], dz = max[2] - min[2];
+            return dx * dy + dy * dz + dz * dx;
+        }
+    };
+
+    static void set_bound(Node &n, const Box &b) {
+        for (int k = 0; k < 3; k++) {
+            n.bound_min[k] = b.min[k];
+            n.bound_max[k] = b.max[k];
+        }
+    }
+
+    //slab test, the entry parameter of the segment or infinity on a miss
+    static double entry(const Node &n, const double origin[3], const double inverse_dir[3]) {
+        double t_min = 0, t_max = 1;
+        for (int k = 0; k < 3; k++) {
+            double t1 = (n.bound_min[k] - origin[k]) * inverse_dir[k];
+            double t2 = (n.bound_max[k] - origin[k]) * inverse_dir[k];
+            if (t1 > t2)
+                std::swap(t1, t2);
+            //NaN from 0 * inf keeps the slab open
+            if (t1 > t_min) t_min = t1;
+            if (t2 < t_max) t_max = t2;
+        }
+        return t_min <= t_max ? t_min : std::numeric_limits<double>::infinity();
+    }
+
+    //a leaf costs one kernel pass per leaf_size primitives, so SAH counts primitives in those groups
+    static uint32_t leaf_pass(uint32_t count) {
+        return (count + leaf_size - 1) / leaf_size;
+    }
+
+    //partition primitive[begin, end) at the cheapest binned SAH plane, returns begin when a leaf is cheaper
+    uint32_t split(const std::vector<Box> &box, const Box &centroid_bound, const Box &bound, uint32_t begin, uint32_t end) {
+        int best_axis = -1, best_bin = 0;
+        double best_cost = leaf_pass(end - begin) * bound.half_area();
+        for (int axis = 0; axis < 3; axis++) {
+            double lo = centroid_bound.min[axis], extent = centroid_bound.max[axis] - lo;
+            if (extent <= 0)
+                continue;
+            Box bin_box[bin_number];
+            uint32_t bin_count[bin_number] = {};
+            for (uint32_t i = begin; i < end; i++) {
+                int b = std::min(bin_number - 1, int((box[primitive[i]].center()[axis] - lo) / extent * bin_number));
+                bin_count[b]++;
+                bin_box[b].grow(box[primitive[i]]);
+            }
+            //sweep from the right, then evaluate every plane from the left
+            double right_area[bin_number];
+            uint32_t right_count[bin_number];
+            Box right;
+            uint32_t count = 0;
+            for (int b = bin_number - 1; b > 0; b--) {
+                right.grow(bin_box[b]);
+                count += bin_count[b];
+                right_area[b] = right.half_area();
+                right_count[b] = count;
+            }
+            Box left;
+            count = 0;
+            for (int b = 0; b < bin_number - 1; b++) {
+                left.grow(bin_box[b]);
+                count += bin_count[b];
+                double cost = leaf_pass(count) * left.half_area() + leaf_pass(right_count[b + 1]) * right_area[b + 1];
+                if (count > 0 && right_count[b + 1] > 0 && cost < best_cost) {
+                    best_cost = cost;
+                    best_axis = axis;
+                    best_bin = b;
+                }
+            }
+        }
+        if (best_axis < 0)
+            return begin;
+
+        double lo = centroid_bound.min[best_axis], extent = centroid_bound.max[best_axis] - lo;
+        auto mid = std::partition(primitive.begin() + begin, primitive.begin() + end, [&](uint32_t p) {
+            return std::min(bin_number - 1, int((box[p].center()[best_axis] - lo) / extent * bin_number)) <= best_bin;
+        });
+        return mid - primitive.begin();
+    }
+
+    //children were appended in pairs; renumber so every left child directly follows its parent
+    void reorder_depth_first() {
+        std::vector<Node> ordered;
+        ordered.reserve(node.size());
+        std::vector<std::pair<uint32_t, uint32_t>> stack = {{0, UINT32_MAX}}; //(old index, new parent waiting for a right child)
+        while (!stack.empty()) {
+            auto [old_index, parent] = stack.back();
+            stack.pop_back();
+            uint32_t new_index = ordered.size();
+            if (parent != UINT32_MAX)
+                ordered[parent].offset = new_index;
+            ordered.push_back(node[old_index]);
+            if (node[old_index].count == 0) {
+                uint32_t left = node[old_index].offset - 1;
+                stack.push_back({node[old_index].offset, new_index});
+                stack.push_back({left, UINT32_MAX});
+            }
+        }
+        node.swap(ordered);
+    }
+};
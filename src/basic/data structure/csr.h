@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+
+#include "utils/parallel/parallel.h"
+
+// Row -> item incidence in CSR form: the items of row r are item[offset[r], offset[r + 1]) in increasing order.
+// Built in two parallel passes over the items: atomic per-row counters, a prefix sum, then a fill through
+// atomic cursors; each row is sorted afterwards so the result does not depend on the thread schedule.
+struct CSR_Incidence {
+    std::vector<uint32_t> offset;
+    std::vector<uint32_t> item;
+
+    uint32_t row_size(size_t r) const {
+        return offset[r + 1] - offset[r];
+    }
+
+    const uint32_t *row_begin(size_t r) const {
+        return item.data() + offset[r];
+    }
+
+    const uint32_t *row_end(size_t r) const {
+        return item.data() + offset[r + 1];
+    }
+
+    //for_each_row(i, f) calls f(row) for every row item i belongs to, an item listed twice in a row appears twice
+    template<typename For_Each_Row>
+    void build(size_t row_number, size_t item_number, For_Each_Row for_each_row) {
+        std::vector<std::atomic<uint32_t>> cursor(row_number);
+        parallel_for(row_number, [&](size_t r) { cursor[r].store(0, std::memory_order_relaxed); });
+        parallel_for(item_number, [&](size_t i) {
+            for_each_row(i, [&](uint32_t r) { cursor[r].fetch_add(1, std::memory_order_relaxed); });
+        });
+
+        offset.assign(row_number + 1, 0);
+        for (size_t r = 0; r < row_number; r++) {
+            offset[r + 1] = offset[r] + cursor[r].load(std::memory_order_relaxed);
+            cursor[r].store(0, std::memory_order_relaxed);
+        }
+
+        item.resize(offset[row_number]);
+        parallel_for(item_number, [&](size_t i) {
+            for_each_row(i, [&](uint32_t r) {
+                item[offset[r] + cursor[r].fetch_add(1, std::memory_order_relaxed)] = i;
+            });
+        });
+        parallel_for(row_number, [&](size_t r) {
+            std::sort(item.begin() + offset[r], item.begin() + offset[r + 1]);
+        });
+    }
+};
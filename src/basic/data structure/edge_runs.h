@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <utility>
+
+#include "basic/data structure/radix_sort.h"
+#include "utils/parallel/parallel.h"
+
+// The edge slots (face * 3 + k) of a triangle list grouped by their undirected edge.
+// Slots are radix sorted on the packed (min, max) vertex key, so the slots of run r are
+// slot[run_offset[r], run_offset[r + 1]) in increasing order and the runs follow the key order.
+struct Edge_Runs {
+    std::vector<uint32_t> slot;
+    std::vector<uint32_t> run_offset;
+
+    size_t run_number() const {
+        return run_offset.empty() ? 0 : run_offset.size() - 1;
+    }
+
+    //edge_vertex(slot) returns the pair of vertex indices of the slot, both below vertex_number
+    template<typename Edge_Vertex>
+    void build(size_t slot_number, size_t vertex_number, Edge_Vertex edge_vertex) {
+        struct Edge_Key {
+            uint64_t key;
+            uint32_t slot;
+        };
+
+        int bits = 1;
+        while (bits < 32 && (vertex_number - 1) >> bits)
+            bits++;
+
+        std::vector<Edge_Key> keys(slot_number);
+        parallel_for(slot_number, [&](size_t i) {
+            std::pair<uint32_t, uint32_t> edge = edge_vertex(i);
+            if (edge.first > edge.second)
+                std::swap(edge.first, edge.second);
+            keys[i] = {(uint64_t) edge.first << bits | edge.second, (uint32_t) i};
+        });
+        radix_sort(keys, (2 * bits + 15) / 16, [](const Edge_Key &key, int d) -> uint32_t {
+            return (key.key >> (d * 16)) & 0xffff;
+        });
+
+        slot.resize(slot_number);
+        run_offset.clear();
+        for (size_t i = 0; i < slot_number; i++) {
+            if (i == 0 || keys[i].key != keys[i - 1].key)
+                run_offset.push_back(i);
+            slot[i] = keys[i].slot;
+        }
+        run_offset.push_back(slot_number);
+    }
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "utils/parallel/parallel.h"
+
+// Stable LSD radix sort on 16-bit digits.
+// digit(item, d) returns digit d of the item's key, d = 0 is the least significant one.
+// Each pass counts per block, prefix sums (digit major, block minor) and scatters the blocks in parallel;
+// passes where every item has the same digit are skipped.
+template<typename T, typename Digit>
+void radix_sort(std::vector<T> &items, int digit_number, Digit digit) {
+    const size_t radix = 1 << 16;
+    const size_t n = items.size();
+    if (n < 2)
+        return;
+
+    const size_t min_block_size = 1 << 16;
+    size_t block_number = std::min<size_t>(get_thread_number(), (n + min_block_size - 1) / min_block_size);
+    size_t block_size = (n + block_number - 1) / block_number;
+
+    std::vector<T> buffer(n);
+    std::vector<size_t> count(block_number * radix);
+    T *src = items.data();
+    T *dst = buffer.data();
+
+    for (int d = 0; d < digit_number; d++) {
+        std::fill(count.begin(), count.end(), 0);
+        parallel_for(block_number, [&](size_t b) {
+            size_t *c = &count[b * radix];
+            size_t end = std::min(n, (b + 1) * block_size);
+            for (size_t i = b * block_size; i < end; i++)
+                c[digit(src[i], d)]++;
+        }, 1);
+
+        bool skip = false;
+        size_t offset = 0;
+        for (size_t r = 0; r < radix && !skip; r++) {
+            size_t bucket_begin = offset;
+            for (size_t b = 0; b < block_number; b++) {
+                size_t c = count[b * radix + r];
+                count[b * radix + r] = offset;
+                offset += c;
+            }
+            skip = offset - bucket_begin == n;
+        }
+        if (skip)
+            continue;
+
+        parallel_for(block_number, [&](size_t b) {
+            size_t *c = &count[b * radix];
+            size_t end = std::min(n, (b + 1) * block_size);
+            for (size_t i = b * block_size; i < end; i++)
+                dst[c[digit(src[i], d)]++] = src[i];
+        }, 1);
+        std::swap(src, dst);
+    }
+
+    if (src != items.data())
+        items.swap(buffer);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <atomic>
+#include <utility>
+
+// Lock-free disjoint sets over [0, n), unite and find may run from many threads at once.
+// A root is only ever linked under a smaller index with a CAS, so the forest stays acyclic; find halves paths.
+class Concurrent_Union_Find {
+public:
+    explicit Concurrent_Union_Find(size_t n) : parent(n) {
+        for (size_t i = 0; i < n; i++)
+            parent[i].store(i, std::memory_order_relaxed);
+    }
+
+    uint32_t find(uint32_t x) {
+        while (true) {
+            uint32_t p = parent[x].load(std::memory_order_relaxed);
+            if (p == x)
+                return x;
+            uint32_t gp = parent[p].load(std::memory_order_relaxed);
+            if (p != gp)
+                parent[x].compare_exchange_weak(p, gp, std::memory_order_relaxed);
+            x = gp;
+        }
+    }
+
+    void unite(uint32_t a, uint32_t b) {
+        while (true) {
+            a = find(a);
+            b = find(b);
+            if (a == b)
+                return;
+            if (a < b)
+                std::swap(a, b);
+            uint32_t expected = a;
+            if (parent[a].compare_exchange_strong(expected, b, std::memory_order_relaxed))
+                return;
+        }
+    }
+
+private:
+    std::vector<std::atomic<uint32_t>> parent;
+};
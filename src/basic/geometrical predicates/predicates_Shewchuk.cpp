@@ -889,7 +889,7 @@ int expansion_sum_zeroelim2(int elen, REAL* e, int flen, REAL* f, REAL* h)
 /*                                                                           */
 /*****************************************************************************/
 
-static int fast_expansion_sum(int elen, REAL* e, int flen, REAL* f, REAL* h)
+[[maybe_unused]] static int fast_expansion_sum(int elen, REAL* e, int flen, REAL* f, REAL* h)
 /* h cannot be e or f. */
 {
     REAL Q;
@@ -1185,7 +1185,7 @@ int linear_expansion_sum_zeroelim(int elen, REAL* e, int flen, REAL* f,
 /*  will h.)                                                                 */
 /*                                                                           */
 /*****************************************************************************/
-static
+[[maybe_unused]] static
 int scale_expansion(int elen, REAL* e, REAL b, REAL* h)
 /* e and h cannot be the same. */
 {
@@ -1283,7 +1283,7 @@ int scale_expansion_zeroelim(int elen, REAL* e, REAL b, REAL* h)
 /*  nonadjacent expansion.                                                   */
 /*                                                                           */
 /*****************************************************************************/
-static
+[[maybe_unused]] static
 int compress(int elen, REAL* e, REAL* h)
 /* e and h may be the same. */
 {
@@ -1365,7 +1365,7 @@ REAL estimate(int elen, REAL* e)
 /*  nearly so.                                                               */
 /*                                                                           */
 /*****************************************************************************/
-static
+[[maybe_unused]] static
 REAL orient2dfast(REAL* pa, REAL* pb, REAL* pc)
 {
     REAL acx, bcx, acy, bcy;
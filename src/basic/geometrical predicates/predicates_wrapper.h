@@ -6,6 +6,7 @@
 #define TETGEO_PREDICATES_WRAPPER_H
 
 #include "basic/math/vector3.h"
+#include "robust_predicates.h"
 
 
 namespace Geometrical_Predicates {
@@ -91,25 +92,8 @@ namespace Geometrical_Predicates {
     }
 
     inline bool toleft(const Vector3 &p1, const Vector3 &p2, const Vector3 &p3, const Vector3 &s) {
-        //ORIENT3D
-
-        double a11, a12, a13;
-        double a21, a22, a23;
-        double a31, a32, a33;
-
-        a11 = p1.x - s.x;
-        a12 = p1.y - s.y;
-        a13 = p1.z - s.z;
-        a21 = p2.x - s.x;
-        a22 = p2.y - s.y;
-        a23 = p2.z - s.z;
-        a31 = p3.x - s.x;
-        a32 = p3.y - s.y;
-        a33 = p3.z - s.z;
-
-        double value = a11 * a22 * a33 + a12 * a23 * a31 + a13 * a21 * a32 - a31 * a22 * a13 - a32 * a23 * a11 - a21 * a12 * a33;
-
-        return value > 1e-8;
+        //ORIENT3D, exact: det[p1 - s; p2 - s; p3 - s] > 0
+        return orient3d_sign(p1, p2, p3, s) > 0;
     }
 
     inline bool colinear(const Vector3 &a, const Vector3 &b, const Vector3 &c) {
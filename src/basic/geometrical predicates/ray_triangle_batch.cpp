@@ -0,0 +1,246 @@
+#include "ray_triangle_batch.h"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define RAY_KERNEL_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+//msvc accepts any intrinsic in any function, gcc and clang need the target per function
+#if defined(RAY_KERNEL_X86) && (defined(__GNUC__) || defined(__clang__))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define TARGET_AVX2
+#define TARGET_AVX512
+#endif
+
+namespace Geometrical_Predicates {
+
+    void Triangle_Batch::clear() {
+        for (auto array: {&p1x, &p1y, &p1z, &e1x, &e1y, &e1z, &e2x, &e2y, &e2z, &normal_length})
+            array->clear();
+    }
+
+    void Triangle_Batch::reserve(size_t n) {
+        for (auto array: {&p1x, &p1y, &p1z, &e1x, &e1y, &e1z, &e2x, &e2y, &e2z, &normal_length})
+            array->reserve(n);
+    }
+
+    void Triangle_Batch::push_back(const Triangle3d &t) {
+        Vector3 e1 = t.p2 - t.p1, e2 = t.p3 - t.p1;
+        p1x.push_back(t.p1.x);
+        p1y.push_back(t.p1.y);
+        p1z.push_back(t.p1.z);
+        e1x.push_back(e1.x);
+        e1y.push_back(e1.y);
+        e1z.push_back(e1.z);
+        e2x.push_back(e2.x);
+        e2y.push_back(e2.y);
+        e2z.push_back(e2.z);
+        normal_length.push_back(vector_length(e1.cross(e2)));
+    }
+
+    namespace {
+        const double no_hit = std::numeric_limits<double>::infinity();
+
+        void kernel_scalar(const Triangle_Batch &b, size_t begin, size_t end, const double o[3], const double d[3], double lo, double *t_out) {
+            for (size_t i = begin; i < end; i++) {
+                double px = d[1] * b.e2z[i] - d[2] * b.e2y[i];
+                double py = d[2] * b.e2x[i] - d[0] * b.e2z[i];
+                double pz = d[0] * b.e2y[i] - d[1] * b.e2x[i];
+                double det = b.e1x[i] * px + b.e1y[i] * py + b.e1z[i] * pz;
+                double sx = o[0] - b.p1x[i], sy = o[1] - b.p1y[i], sz = o[2] - b.p1z[i];
+                double inv = 1 / det;
+                double u = (sx * px + sy * py + sz * pz) * inv;
+                double qx = sy * b.e1z[i] - sz * b.e1y[i];
+                double qy = sz * b.e1x[i] - sx * b.e1z[i];
+                double qz = sx * b.e1y[i] - sy * b.e1x[i];
+                double v = (d[0] * qx + d[1] * qy + d[2] * qz) * inv;
+                double t = (b.e2x[i] * qx + b.e2y[i] * qy + b.e2z[i] * qz) * inv;
+                double w = 1 - u - v;
+                bool ok = std::fabs(det) > ray_triangle_epsilon * b.normal_length[i] && u > lo && v > lo && w > lo && t >= 0 && t <= 1;
+                t_out[i - begin] = ok ? t : no_hit;
+            }
+        }
+
+#ifdef RAY_KERNEL_X86
+        TARGET_AVX2
+        void kernel_avx2(const Triangle_Batch &b, size_t begin, size_t end, const double o[3], const double d[3], double lo, double *t_out) {
+            const __m256d dx = _mm256_set1_pd(d[0]), dy = _mm256_set1_pd(d[1]), dz = _mm256_set1_pd(d[2]);
+            const __m256d ox = _mm256_set1_pd(o[0]), oy = _mm256_set1_pd(o[1]), oz = _mm256_set1_pd(o[2]);
+            const __m256d eps = _mm256_set1_pd(ray_triangle_epsilon), low = _mm256_set1_pd(lo);
+            const __m256d zero = _mm256_setzero_pd(), one = _mm256_set1_pd(1), miss = _mm256_set1_pd(no_hit);
+            const __m256d sign = _mm256_set1_pd(-0.0);
+            size_t i = begin;
+            for (; i + 4 <= end; i += 4) {
+                __m256d e1x = _mm256_loadu_pd(&b.e1x[i]), e1y = _mm256_loadu_pd(&b.e1y[i]), e1z = _mm256_loadu_pd(&b.e1z[i]);
+                __m256d e2x = _mm256_loadu_pd(&b.e2x[i]), e2y = _mm256_loadu_pd(&b.e2y[i]), e2z = _mm256_loadu_pd(&b.e2z[i]);
+                __m256d px = _mm256_sub_pd(_mm256_mul_pd(dy, e2z), _mm256_mul_pd(dz, e2y));
+                __m256d py = _mm256_sub_pd(_mm256_mul_pd(dz, e2x), _mm256_mul_pd(dx, e2z));
+                __m256d pz = _mm256_sub_pd(_mm256_mul_pd(dx, e2y), _mm256_mul_pd(dy, e2x));
+                __m256d det = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(e1x, px), _mm256_mul_pd(e1y, py)), _mm256_mul_pd(e1z, pz));
+                __m256d sx = _mm256_sub_pd(ox, _mm256_loadu_pd(&b.p1x[i]));
+                __m256d sy = _mm256_sub_pd(oy, _mm256_loadu_pd(&b.p1y[i]));
+                __m256d sz = _mm256_sub_pd(oz, _mm256_loadu_pd(&b.p1z[i]));
+                __m256d inv = _mm256_div_pd(one, det);
+                __m256d u = _mm256_mul_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(sx, px), _mm256_mul_pd(sy, py)), _mm256_mul_pd(sz, pz)), inv);
+                __m256d qx = _mm256_sub_pd(_mm256_mul_pd(sy, e1z), _mm256_mul_pd(sz, e1y));
+                __m256d qy = _mm256_sub_pd(_mm256_mul_pd(sz, e1x), _mm256_mul_pd(sx, e1z));
+                __m256d qz = _mm256_sub_pd(_mm256_mul_pd(sx, e1y), _mm256_mul_pd(sy, e1x));
+                __m256d v = _mm256_mul_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, qx), _mm256_mul_pd(dy, qy)), _mm256_mul_pd(dz, qz)), inv);
+                __m256d t = _mm256_mul_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(e2x, qx), _mm256_mul_pd(e2y, qy)), _mm256_mul_pd(e2z, qz)), inv);
+                __m256d w = _mm256_sub_pd(_mm256_sub_pd(one, u), v);
+
+                __m256d ok = _mm256_cmp_pd(_mm256_andnot_pd(sign, det), _mm256_mul_pd(eps, _mm256_loadu_pd(&b.normal_length[i])), _CMP_GT_OQ);
+                ok = _mm256_and_pd(ok, _mm256_cmp_pd(u, low, _CMP_GT_OQ));
+                ok = _mm256_and_pd(ok, _mm256_cmp_pd(v, low, _CMP_GT_OQ));
+                ok = _mm256_and_pd(ok, _mm256_cmp_pd(w, low, _CMP_GT_OQ));
+                ok = _mm256_and_pd(ok, _mm256_cmp_pd(t, zero, _CMP_GE_OQ));
+                ok = _mm256_and_pd(ok, _mm256_cmp_pd(t, one, _CMP_LE_OQ));
+                _mm256_storeu_pd(t_out + (i - begin), _mm256_blendv_pd(miss, t, ok));
+            }
+            kernel_scalar(b, i, end, o, d, lo, t_out + (i - begin));
+        }
+
+        TARGET_AVX512
+        void kernel_avx512(const Triangle_Batch &b, size_t begin, size_t end, const double o[3], const double d[3], double lo, double *t_out) {
+            const __m512d dx = _mm512_set1_pd(d[0]), dy = _mm512_set1_pd(d[1]), dz = _mm512_set1_pd(d[2]);
+            const __m512d ox = _mm512_set1_pd(o[0]), oy = _mm512_set1_pd(o[1]), oz = _mm512_set1_pd(o[2]);
+            const __m512d eps = _mm512_set1_pd(ray_triangle_epsilon), low = _mm512_set1_pd(lo);
+            const __m512d zero = _mm512_setzero_pd(), one = _mm512_set1_pd(1), miss = _mm512_set1_pd(no_hit);
+            size_t i = begin;
+            for (; i + 8 <= end; i += 8) {
+                __m512d e1x = _mm512_loadu_pd(&b.e1x[i]), e1y = _mm512_loadu_pd(&b.e1y[i]), e1z = _mm512_loadu_pd(&b.e1z[i]);
+                __m512d e2x = _mm512_loadu_pd(&b.e2x[i]), e2y = _mm512_loadu_pd(&b.e2y[i]), e2z = _mm512_loadu_pd(&b.e2z[i]);
+                __m512d px = _mm512_sub_pd(_mm512_mul_pd(dy, e2z), _mm512_mul_pd(dz, e2y));
+                __m512d py = _mm512_sub_pd(_mm512_mul_pd(dz, e2x), _mm512_mul_pd(dx, e2z));
+                __m512d pz = _mm512_sub_pd(_mm512_mul_pd(dx, e2y), _mm512_mul_pd(dy, e2x));
+                __m512d det = _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(e1x, px), _mm512_mul_pd(e1y, py)), _mm512_mul_pd(e1z, pz));
+                __m512d sx = _mm512_sub_pd(ox, _mm512_loadu_pd(&b.p1x[i]));
+                __m512d sy = _mm512_sub_pd(oy, _mm512_loadu_pd(&b.p1y[i]));
+                __m512d sz = _mm512_sub_pd(oz, _mm512_loadu_pd(&b.p1z[i]));
+                __m512d inv = _mm512_div_pd(one, det);
+                __m512d u = _mm512_mul_pd(_mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(sx, px), _mm512_mul_pd(sy, py)), _mm512_mul_pd(sz, pz)), inv);
+                __m512d qx = _mm512_sub_pd(_mm512_mul_pd(sy, e1z), _mm512_mul_pd(sz, e1y));
+                __m512d qy = _mm512_sub_pd(_mm512_mul_pd(sz, e1x), _mm512_mul_pd(sx, e1z));
+                __m512d qz = _mm512_sub_pd(_mm512_mul_pd(sx, e1y), _mm512_mul_pd(sy, e1x));
+                __m512d v = _mm512_mul_pd(_mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(dx, qx), _mm512_mul_pd(dy, qy)), _mm512_mul_pd(dz, qz)), inv);
+                __m512d t = _mm512_mul_pd(_mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(e2x, qx), _mm512_mul_pd(e2y, qy)), _mm512_mul_pd(e2z, qz)), inv);
+                __m512d w = _mm512_sub_pd(_mm512_sub_pd(one, u), v);
+
+                __mmask8 ok = _mm512_cmp_pd_mask(_mm512_abs_pd(det), _mm512_mul_pd(eps, _mm512_loadu_pd(&b.normal_length[i])), _CMP_GT_OQ);
+                ok &= _mm512_cmp_pd_mask(u, low, _CMP_GT_OQ);
+                ok &= _mm512_cmp_pd_mask(v, low, _CMP_GT_OQ);
+                ok &= _mm512_cmp_pd_mask(w, low, _CMP_GT_OQ);
+                ok &= _mm512_cmp_pd_mask(t, zero, _CMP_GE_OQ);
+                ok &= _mm512_cmp_pd_mask(t, one, _CMP_LE_OQ);
+                _mm512_storeu_pd(t_out + (i - begin), _mm512_mask_blend_pd(ok, miss, t));
+            }
+            kernel_scalar(b, i, end, o, d, lo, t_out + (i - begin));
+        }
+
+        bool cpu_support(Ray_Kernel kernel) {
+#if defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 0);
+            if (info[0] < 7)
+                return false;
+            __cpuid(info, 1);
+            bool os_avx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 0x6) == 0x6;
+            if (!os_avx)
+                return false;
+            __cpuidex(info, 7, 0);
+            if (kernel == Ray_Kernel::avx2)
+                return info[1] & (1 << 5);
+            return (info[1] & (1 << 16)) && (_xgetbv(0) & 0xe6) == 0xe6;
+#else
+            __builtin_cpu_init();
+            if (kernel == Ray_Kernel::avx2)
+                return __builtin_cpu_supports("avx2");
+            return __builtin_cpu_supports("avx512f");
+#endif
+        }
+#endif
+
+        void intersect(const Triangle_Batch &batch, size_t begin, size_t end, const Ray3d &ray, bool include_border, double *t, Ray_Kernel kernel) {
+            double o[3] = {ray.from.x, ray.from.y, ray.from.z};
+            double d[3] = {ray.to.x - ray.from.x, ray.to.y - ray.from.y, ray.to.z - ray.from.z};
+            double lo = include_border ? -ray_triangle_epsilon : ray_triangle_epsilon;
+#ifdef RAY_KERNEL_X86
+            if (kernel == Ray_Kernel::avx512) {
+                kernel_avx512(batch, begin, end, o, d, lo, t);
+                return;
+            }
+            if (kernel == Ray_Kernel::avx2) {
+                kernel_avx2(batch, begin, end, o, d, lo, t);
+                return;
+            }
+#endif
+            kernel_scalar(batch, begin, end, o, d, lo, t);
+        }
+
+        //closest hit in blocks of triangles, so the parameters stay on the stack
+        int nearest_in_range(const Triangle_Batch &batch, size_t begin, size_t end, const Ray3d &ray, bool include_border,
+                             double *hit_t, Ray_Kernel kernel) {
+            const size_t block_size = 256;
+            double t[block_size];
+            double best_t = no_hit;
+            int hit = -1;
+            for (size_t b = begin; b < end; b += block_size) {
+                size_t e = std::min(end, b + block_size);
+                intersect(batch, b, e, ray, include_border, t, kernel);
+                for (size_t i = b; i < e; i++) {
+                    if (t[i - b] != no_hit && t[i - b] <= best_t) {
+                        best_t = t[i - b];
+                        hit = i;
+                    }
+                }
+            }
+            if (hit_t != nullptr)
+                *hit_t = best_t;
+            return hit;
+        }
+    }
+
+    Ray_Kernel detect_ray_kernel() {
+        static const Ray_Kernel kernel = [] {
+#ifdef RAY_KERNEL_X86
+            if (cpu_support(Ray_Kernel::avx512))
+                return Ray_Kernel::avx512;
+            if (cpu_support(Ray_Kernel::avx2))
+                return Ray_Kernel::avx2;
+#endif
+            return Ray_Kernel::scalar;
+        }();
+        return kernel;
+    }
+
+    const char *ray_kernel_name(Ray_Kernel kernel) {
+        switch (kernel) {
+            case Ray_Kernel::avx512:
+                return "avx512";
+            case Ray_Kernel::avx2:
+                return "avx2";
+            default:
+                return "scalar";
+        }
+    }
+
+    //a kernel the cpu can not execute falls back to the best one it can
+    void intersect_segment_batch(const Triangle_Batch &batch, size_t begin, size_t end, const Ray3d &ray, bool include_border,
+                                 double *t, Ray_Kernel kernel) {
+        intersect(batch, begin, end, ray, include_border, t, std::min(kernel, detect_ray_kernel()));
+    }
+
+    int nearest_segment_hit(const Triangle_Batch &batch, size_t begin, size_t end, const Ray3d &ray, bool include_border,
+                            double *hit_t, Ray_Kernel kernel) {
+        return nearest_in_range(batch, begin, end, ray, include_border, hit_t, std::min(kernel, detect_ray_kernel()));
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef TETGEO_RAY_TRIANGLE_BATCH_H
+#define TETGEO_RAY_TRIANGLE_BATCH_H
+
+#include <cstddef>
+#include <vector>
+
+#include "predicates_wrapper.h"
+
+namespace Geometrical_Predicates {
+
+    //Triangles packed as structure of arrays for the batched Moller-Trumbore kernels:
+    //p1, the edges e1 = p2 - p1, e2 = p3 - p1 and |e1 x e2|.
+    struct Triangle_Batch {
+        std::vector<double> p1x, p1y, p1z;
+        std::vector<double> e1x, e1y, e1z;
+        std::vector<double> e2x, e2y, e2z;
+        std::vector<double> normal_length;
+
+        size_t size() const {
+            return p1x.size();
+        }
+
+        void clear();
+
+        void reserve(size_t n);
+
+        void push_back(const Triangle3d &t);
+    };
+
+    //Hit rules shared by every kernel, all relative to the triangle:
+    //  the segment is parallel when |dir . n / |n|| < eps with n = e1 x e2, i.e. |det| < eps * |e1 x e2|,
+    //  barycentrics u, v and 1 - u - v must all be > eps, or > -eps when the border is included,
+    //  the segment parameter t must lie in [0, 1].
+    const double ray_triangle_epsilon = 1e-8;
+
+    enum class Ray_Kernel {
+        scalar,
+        avx2,
+        avx512
+    };
+
+    //the widest kernel the cpu and os support, detected once
+    Ray_Kernel detect_ray_kernel();
+
+    const char *ray_kernel_name(Ray_Kernel kernel);
+
+    //t[i - begin] receives the parameter of the hit of segment ray.from -> ray.to with triangle i, or infinity
+    void intersect_segment_batch(const Triangle_Batch &batch, size_t begin, size_t end, const Ray3d &ray, bool include_border,
+                                 double *t, Ray_Kernel kernel = detect_ray_kernel());
+
+    //closest hit in [begin, end), ties go to the larger index; returns the index or -1
+    int nearest_segment_hit(const Triangle_Batch &batch, size_t begin, size_t end, const Ray3d &ray, bool include_border,
+                            double *hit_t = nullptr, Ray_Kernel kernel = detect_ray_kernel());
+}
+
+#endif //TETGEO_RAY_TRIANGLE_BATCH_H
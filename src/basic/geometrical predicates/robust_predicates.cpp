@@ -0,0 +1,85 @@
+//the filter bound is derived for separately rounded products, CMakeLists.txt builds this file without contraction
+#include "robust_predicates.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "predicates_Shewchuk.h"
+
+namespace Geometrical_Predicates {
+
+    //forward error of orient3d_determinant relative to the product of the largest |differences| per axis
+    static const double orient3d_filter_constant = 5.1107127829973299e-15;
+
+    //the plain floating point determinant, same expression as Shewchuk's orient3dfast
+    static inline double orient3d_determinant(const Vector3 &a, const Vector3 &b, const Vector3 &c, const Vector3 &d) {
+        double adx = a.x - d.x, ady = a.y - d.y, adz = a.z - d.z;
+        double bdx = b.x - d.x, bdy = b.y - d.y, bdz = b.z - d.z;
+        double cdx = c.x - d.x, cdy = c.y - d.y, cdz = c.z - d.z;
+        return adz * (bdx * cdy - cdx * bdy) + bdz * (cdx * ady - adx * cdy) + cdz * (adx * bdy - bdx * ady);
+    }
+
+    //outside this range the products of differences may under- or overflow and the constant no longer holds
+    static bool filter_in_range(double max_x, double max_y, double max_z) {
+        double low = std::min(max_x, std::min(max_y, max_z));
+        double high = std::max(max_x, std::max(max_y, max_z));
+        return low >= 1e-97 && high <= 1e102;
+    }
+
+    static int exact_sign(const Vector3 &a, const Vector3 &b, const Vector3 &c, const Vector3 &d) {
+        //error bounds and splitter of the exact arithmetic, Shewchuk's own static filter is off since ours ran first
+        static const bool initialized = (exactinit(0, 0, 1, 0, 0, 0), true);
+        (void) initialized;
+
+        double pa[3] = {a.x, a.y, a.z}, pb[3] = {b.x, b.y, b.z}, pc[3] = {c.x, c.y, c.z}, pd[3] = {d.x, d.y, d.z};
+        double det = orient3d(pa, pb, pc, pd);
+        return (det > 0) - (det < 0);
+    }
+
+    Orient3d_Filter::Orient3d_Filter(const Vector3 &extent) {
+        double x = std::fabs(extent.x), y = std::fabs(extent.y), z = std::fabs(extent.z);
+        //a zero extent makes every determinant exactly 0, those are checked exactly anyway
+        if (x == 0 || y == 0 || z == 0 || filter_in_range(x, y, z))
+            error_bound = orient3d_filter_constant * x * y * z;
+        else
+            error_bound = std::numeric_limits<double>::infinity();
+    }
+
+    int orient3d_sign(const Vector3 &a, const Vector3 &b, const Vector3 &c, const Vector3 &d) {
+        double max_x = std::max(std::fabs(a.x - d.x), std::max(std::fabs(b.x - d.x), std::fabs(c.x - d.x)));
+        double max_y = std::max(std::fabs(a.y - d.y), std::max(std::fabs(b.y - d.y), std::fabs(c.y - d.y)));
+        double max_z = std::max(std::fabs(a.z - d.z), std::max(std::fabs(b.z - d.z), std::fabs(c.z - d.z)));
+        if (filter_in_range(max_x, max_y, max_z)) {
+            double det = orient3d_determinant(a, b, c, d);
+            double bound = orient3d_filter_constant * max_x * max_y * max_z;
+            if (det > bound)
+                return 1;
+            if (det < -bound)
+                return -1;
+        }
+        return exact_sign(a, b, c, d);
+    }
+
+    int orient3d_sign(const Orient3d_Filter &filter, const Vector3 &a, const Vector3 &b, const Vector3 &c, const Vector3 &d) {
+        double det = orient3d_determinant(a, b, c, d);
+        if (det > filter.error_bound)
+            return 1;
+        if (det < -filter.error_bound)
+            return -1;
+        return exact_sign(a, b, c, d);
+    }
+
+    void orient3d_sign_batch(const Orient3d_Filter &filter, const Vector3 *a, const Vector3 *b, const Vector3 *c, const Vector3 *d,
+                             size_t n, int *sign) {
+        const double bound = filter.error_bound;
+        for (size_t i = 0; i < n; i++) {
+            double det = orient3d_determinant(a[i], b[i], c[i], d[i]);
+            sign[i] = (det > bound) - (det < -bound);
+        }
+        for (size_t i = 0; i < n; i++) {
+            if (sign[i] == 0)
+                sign[i] = exact_sign(a[i], b[i], c[i], d[i]);
+        }
+    }
+}
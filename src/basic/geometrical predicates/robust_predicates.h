@@ -0,0 +1,35 @@
+#ifndef TETGEO_ROBUST_PREDICATES_H
+#define TETGEO_ROBUST_PREDICATES_H
+
+#include <cstddef>
+
+#include "basic/math/vector3.h"
+
+namespace Geometrical_Predicates {
+    using base_type::Vector3;
+
+    //Sign of orient3d(a, b, c, d) = det[a - d; b - d; c - d], Shewchuk's convention: positive when d lies below the
+    //plane through a, b, c, which appear counterclockwise seen from above; 0 only when the four points are coplanar.
+    //The determinant is evaluated in doubles and accepted when it is farther from 0 than a forward error bound
+    //(the TetGen / CGAL orient3d filter constant times the largest coordinate differences); the rest goes to
+    //Shewchuk's adaptive exact orient3d.
+
+    //static filter: one bound for every query whose points lie in a box of the given size
+    struct Orient3d_Filter {
+        double error_bound;
+
+        explicit Orient3d_Filter(const Vector3 &extent);
+    };
+
+    //bound from the coordinate differences of this query
+    int orient3d_sign(const Vector3 &a, const Vector3 &b, const Vector3 &c, const Vector3 &d);
+
+    int orient3d_sign(const Orient3d_Filter &filter, const Vector3 &a, const Vector3 &b, const Vector3 &c, const Vector3 &d);
+
+    //sign[i] = orient3d_sign(filter, a[i], b[i], c[i], d[i]); the filter pass has no branches so it vectorizes,
+    //the uncertain queries are resolved exactly afterwards
+    void orient3d_sign_batch(const Orient3d_Filter &filter, const Vector3 *a, const Vector3 *b, const Vector3 *c, const Vector3 *d,
+                             size_t n, int *sign);
+}
+
+#endif //TETGEO_ROBUST_PREDICATES_H
@@ -12,10 +12,12 @@
 #include <unordered_map>
 #include <set>
 #include <unordered_set>
+#include <atomic>
 
 
 
 #include "basic/data structure/memory_pool.h"
+#include "basic/data structure/edge_runs.h"
 #include "basic/math/vector3.h"
 #include "basic/geometrical predicates/predicates_wrapper.h"
 #include "mesh loader/mesh_loader.h"
@@ -34,29 +36,33 @@ typedef unsigned uint;
 namespace base_type {
     using namespace Geometrical_Predicates;
     struct Edge;
+    struct Face;
     struct Tetrahedra;
 
+    //[first, last) of a CSR incidence array, usable in range for
+    template<typename T>
+    struct Pointer_Range {
+        T **first, **last;
+
+        T **begin() const { return first; }
+
+        T **end() const { return last; }
+    };
+
     struct Vertex {
         Vector3 position;
-        std::vector<Tetrahedra *> *connect_tetrahedra_array;
-        std::vector<Edge *> *connect_edge_array;
         uint static_index;
 
         static Vertex *allocate_from_pool(MemoryPool *pool) {
 
             auto v = (Vertex *) pool->allocate();
-            v->connect_tetrahedra_array = new std::vector<Tetrahedra *>();
-            v->connect_edge_array = new std::vector<Edge *>();
             v->static_index = pool->size() - 1;
             return v;
         }
 
         static Vertex *allocate_from_pool(MemoryPool *pool, Vector3 position) {
-            auto v = (Vertex *) pool->allocate();
+            auto v = allocate_from_pool(pool);
             v->position = position;
-            v->connect_tetrahedra_array = new std::vector<Tetrahedra *>();
-            v->connect_edge_array = new std::vector<Edge *>();
-            v->static_index = pool->size() - 1;
             return v;
         }
 
@@ -132,7 +138,9 @@ namespace base_type {
     struct Edge {
         Vertex *orig;
         Vertex *end;
-        std::vector<Face *> *connect_face_array;
+        //slice of the edge -> face CSR array filled by build_edges
+        Face **connect_face_array;
+        int connect_face_number;
         //for draw debug
         bool draw_red = false;
 
@@ -140,15 +148,59 @@ namespace base_type {
             auto e = (Edge *) pool->allocate();
             e->orig = _orig;
             e->end = _end;
-
-            _orig->connect_edge_array->push_back(e);
-            _end->connect_edge_array->push_back(e);
-            e->connect_face_array = new std::vector<Face *>();
+            e->connect_face_array = nullptr;
+            e->connect_face_number = 0;
             return e;
         }
 
+        Pointer_Range<Face> connect_faces() const {
+            return {connect_face_array, connect_face_array + connect_face_number};
+        }
+
     };
 
+    //Create the unique edges of all faces in face_pool from sorted (min, max) vertex index keys.
+    //slot k of disjoin_edge joins local vertices face_edge[k][0] -> face_edge[k][1] (0 = p1),
+    //edges are allocated in order of first use and their faces are listed in face_pool order.
+    //edge_face is the edge -> face CSR array the edges point into, the caller keeps it alive as long as the edges.
+    inline void build_edges(MemoryPool &edge_pool, MemoryPool &face_pool, size_t vertex_number, const int face_edge[3][2],
+                            std::vector<Face *> &edge_face) {
+        std::vector<Face *> faces(face_pool.size());
+        for (int i = 0; i < faces.size(); i++) {
+            faces[i] = (Face *) face_pool[i];
+        }
+        auto face_vtx = [&](size_t face_slot, int end) {
+            Face *f = faces[face_slot / 3];
+            int local = face_edge[face_slot % 3][end];
+            return local == 0 ? f->p1 : (local == 1 ? f->p2 : f->p3);
+        };
+
+        Edge_Runs runs;
+        runs.build(faces.size() * 3, vertex_number, [&](size_t i) {
+            return std::make_pair((uint32_t) face_vtx(i, 0)->static_index, (uint32_t) face_vtx(i, 1)->static_index);
+        });
+
+        //the run slots are the CSR array, a run starts with its first slot
+        edge_face.assign(runs.slot.size(), nullptr);
+        std::vector<int> run_of_first_slot(runs.slot.size(), -1);
+        for (size_t r = 0; r < runs.run_number(); r++)
+            run_of_first_slot[runs.slot[runs.run_offset[r]]] = r;
+        for (size_t i = 0; i < run_of_first_slot.size(); i++) {
+            int r = run_of_first_slot[i];
+            if (r < 0)
+                continue;
+            uint32_t b = runs.run_offset[r], e = runs.run_offset[r + 1];
+            auto edge = Edge::allocate_from_pool(&edge_pool, face_vtx(i, 0), face_vtx(i, 1));
+            edge->connect_face_array = edge_face.data() + b;
+            edge->connect_face_number = e - b;
+            for (uint32_t j = b; j < e; j++) {
+                Face *f = faces[runs.slot[j] / 3];
+                edge_face[j] = f;
+                f->disjoin_edge[runs.slot[j] % 3] = edge;
+            }
+        }
+    }
+
     struct Tetrahedra {
         int type_id;
         int static_index;
@@ -186,11 +238,6 @@ namespace base_type {
             t->mark = false;
             t->draw_red = false;
 
-            t->p1->connect_tetrahedra_array->push_back(t);
-            t->p2->connect_tetrahedra_array->push_back(t);
-            t->p3->connect_tetrahedra_array->push_back(t);
-            t->p4->connect_tetrahedra_array->push_back(t);
-
             return t;
         }
 
@@ -297,6 +344,8 @@ namespace base_type {
         MemoryPool vertex_pool;
         MemoryPool edge_pool;
         MemoryPool face_pool;
+        //edge -> face CSR array, every edge points at its slice
+        std::vector<Face *> edge_face;
 
         Triangle_Soup_Mesh() {
             vertex_pool.initializePool(sizeof(Vertex), 1000, 8, 32);
@@ -309,6 +358,8 @@ namespace base_type {
             vertex_pool.restart();
             edge_pool.restart();
             face_pool.restart();
+            edge_face.clear();
+            edge_face.shrink_to_fit();
         }
 
         bool is_manifold_2() {
@@ -320,44 +371,16 @@ namespace base_type {
         bool is_closed() {
             for (int i = 0; i < edge_pool.size(); i++) {
                 auto e = (Edge *) edge_pool[i];
-                if (e->connect_face_array->size() != 2)
+                if (e->connect_face_number != 2)
                     return false;
             }
             return true;
         }
 
         void connect_edge_by_face() {
-            auto add_edge_if_not_exist = [](MemoryPool &pool, Vertex *a, Vertex *b) -> Edge * {
-                for (auto &e: *a->connect_edge_array) {
-                    if ((e->end == a && e->orig == b) || (e->orig == a && e->end == b)) {
-                        return e;
-                    }
-                }
-                for (auto &e: *b->connect_edge_array) {
-                    if ((e->end == a && e->orig == b) || (e->orig == a && e->end == b)) {
-                        return e;
-                    }
-                }
-                auto e = Edge::allocate_from_pool(&pool, a, b);
-
-                return e;
-            };
+            static const int face_edge[3][2] = {{1, 2}, {0, 2}, {0, 1}};
             assert(edge_pool.size() == 0);
-            for (int i = 0; i < face_pool.size(); i++) {
-                Face *f = (Face *) face_pool[i];
-
-                auto e_23 = add_edge_if_not_exist(edge_pool, f->p2, f->p3);
-                e_23->connect_face_array->push_back(f);
-                f->disjoin_edge[0] = e_23;
-
-                auto e_13 = add_edge_if_not_exist(edge_pool, f->p1, f->p3);
-                e_13->connect_face_array->push_back(f);
-                f->disjoin_edge[1] = e_13;
-
-                auto e_12 = add_edge_if_not_exist(edge_pool, f->p1, f->p2);
-                e_12->connect_face_array->push_back(f);
-                f->disjoin_edge[2] = e_12;
-            }
+            build_edges(edge_pool, face_pool, vertex_pool.size(), face_edge, edge_face);
         }
 
 
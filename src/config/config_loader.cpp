@@ -17,11 +17,30 @@ void Config_Loader::create_default_config_file(const std::string &path) {
     j["output"]["array_to_number"] = true;
     j["output"]["export_six_surface"] = true;
     j["output"]["export_face_related"] = false;
+    j["output"]["export_vtu"] = true;
+    j["output"]["fast_ascii"] = false;
+    j["output"]["vtu_appended"] = false;
+    j["output"]["update_attributes"] = false;
+    j["output"]["export_vtkhdf"] = false;
+    j["output"]["vtkhdf_compression_level"] = 0;
+    j["output"]["export_exodus"] = false;
+    j["output"]["export_gmsh"] = false;
+    j["output"]["export_f3grid"] = false;
+    j["output"]["export_preview"] = false;
+    j["output"]["streaming_conversion"] = false;
+    j["output"]["merge_boundary_surfaces"] = false;
+    j["output"]["stream_batch_size"] = 1048576;
+    j["output"]["export_io_concurrency"] = 0;
+    j["output"]["spatial_reorder"] = "none";
+    j["output"]["rcm_reorder"] = false;
+    j["output"]["preview_coord_tolerance"] = 1e-3;
+    j["output"]["preview_field_tolerance"] = 1e-3;
 
     j["export_six_surface_setting"]["r_x"] = -50;
     j["export_six_surface_setting"]["r_y"] = 0;
     j["export_six_surface_setting"]["r_z"] = 0;
     j["export_six_surface_setting"]["export_materialids_using_slot"] = 0;
+    j["export_six_surface_setting"]["export_jobs"] = json::array();
 
     std::error_code err;
 
@@ -40,12 +59,48 @@ bool Config_Loader::load_config_file(const std::string &path, Config &c) {
     c.export_six_surface = j["output"]["export_six_surface"];
     c.export_face_related = j["output"]["export_face_related"];
     c.array_to_number = j["output"]["array_to_number"];
+    c.export_vtu = j["output"].value("export_vtu", true);
+    c.fast_ascii = j["output"].value("fast_ascii", false);
+    c.vtu_appended = j["output"].value("vtu_appended", false);
+    c.update_attributes = j["output"].value("update_attributes", false);
+    c.export_vtkhdf = j["output"].value("export_vtkhdf", false);
+    c.vtkhdf_compression_level = j["output"].value("vtkhdf_compression_level", 0);
+    c.export_exodus = j["output"].value("export_exodus", false);
+    c.export_gmsh = j["output"].value("export_gmsh", false);
+    c.export_f3grid = j["output"].value("export_f3grid", false);
+    c.export_preview = j["output"].value("export_preview", false);
+    c.streaming_conversion = j["output"].value("streaming_conversion", false);
+    c.merge_boundary_surfaces = j["output"].value("merge_boundary_surfaces", false);
+    c.stream_batch_size = j["output"].value("stream_batch_size", 1048576);
+    c.export_io_concurrency = j["output"].value("export_io_concurrency", 0);
+    c.spatial_reorder = j["output"].value("spatial_reorder", std::string("none"));
+    if (c.spatial_reorder != "none" && c.spatial_reorder != "morton" && c.spatial_reorder != "hilbert") {
+        log_print("spatial_reorder must be none, morton or hilbert: " + c.spatial_reorder);
+        return false;
+    }
+    c.rcm_reorder = j["output"].value("rcm_reorder", false);
+    c.preview_coord_tolerance = j["output"].value("preview_coord_tolerance", 1e-3);
+    c.preview_field_tolerance = j["output"].value("preview_field_tolerance", 1e-3);
 
     c.r_x = j["export_six_surface_setting"]["r_x"];
     c.r_y = j["export_six_surface_setting"]["r_y"];
     c.r_z = j["export_six_surface_setting"]["r_z"];
     c.export_materialids_using_slot = j["export_six_surface_setting"]["export_materialids_using_slot"];
 
+    //fields missing in a job fall back to the settings above
+    c.export_jobs.clear();
+    for (const auto &job: j["export_six_surface_setting"].value("export_jobs", json::array())) {
+        Export_Job e;
+        e.r_x = job.value("r_x", c.r_x);
+        e.r_y = job.value("r_y", c.r_y);
+        e.r_z = job.value("r_z", c.r_z);
+        e.export_materialids_using_slot = job.value("export_materialids_using_slot", c.export_materialids_using_slot);
+        e.output_subdirectory = job.value("output_subdirectory", std::string());
+        c.export_jobs.push_back(e);
+    }
+    if (c.export_jobs.empty())
+        c.export_jobs.push_back({c.r_x, c.r_y, c.r_z, c.export_materialids_using_slot, ""});
+
     if (j["input"]["input_file_path"].size() != 0) {
         for (std::string element: j["input"]["input_file_path"]) {
             if (!is_file_exist(element)) {
@@ -58,6 +113,7 @@ bool Config_Loader::load_config_file(const std::string &path, Config &c) {
                 if (inString == "vtu") return Mesh_Loader::VTU;
                 if (inString == "mesh") return Mesh_Loader::MESH;
                 if (inString == "f3grid") return Mesh_Loader::F3GRID;
+                if (inString == "f3zp") return Mesh_Loader::F3ZP;
                 return Mesh_Loader::UNKNOW;
             };
 
@@ -68,6 +124,9 @@ bool Config_Loader::load_config_file(const std::string &path, Config &c) {
                 case Mesh_Loader::VTU:
                     c.input_file_path.push_back(element);
                     break;
+                case Mesh_Loader::F3ZP:
+                    c.input_file_path.push_back(element);
+                    break;
                 default:
                     log_print("file format not support:" + element);
                     return false;
@@ -11,14 +11,40 @@
 #include <fstream>
 
 
+//one six-surface export of a session: rotation, material slot and where its files go
+struct Export_Job {
+    double r_x = 0, r_y = 0, r_z = 0;
+    int export_materialids_using_slot = 0;
+    std::string output_subdirectory; //relative to save_output_path, empty writes there directly
+};
+
 struct Config {
     bool export_six_surface = false;
     bool export_face_related = false;
     bool array_to_number = false;
+    bool export_vtu = true;
+    bool fast_ascii = false;
+    bool vtu_appended = false;
+    bool update_attributes = false;
+    bool export_vtkhdf = false;
+    int vtkhdf_compression_level = 0;
+    bool export_exodus = false;
+    bool export_gmsh = false;
+    bool export_f3grid = false;
+    bool export_preview = false;
+    bool streaming_conversion = false;
+    bool merge_boundary_surfaces = false;
+    int stream_batch_size = 1048576;
+    int export_io_concurrency = 0;
+    std::string spatial_reorder = "none"; //none, morton or hilbert
+    bool rcm_reorder = false;
+    double preview_coord_tolerance = 1e-3;
+    double preview_field_tolerance = 1e-3;
     std::vector<std::string> input_file_path;
     std::string save_output_path;
     double r_x = 0, r_y = 0, r_z = 0;
     int export_materialids_using_slot = 0;
+    std::vector<Export_Job> export_jobs; //never empty after loading, the settings above are the single job by default
 };
 
 
@@ -8,8 +8,11 @@
 #include "config/config_loader.h"
 #include "utils/log/log.h"
 #include "utils/file/file_path.h"
+#include "utils/parallel/task_pool.h"
 #include "mesh loader/mesh_loader.h"
 #include "algorithm/extract_six_surface.h"
+#include "algorithm/ray_triangle_benchmark.h"
+#include "algorithm/mesh_reorder.h"
 
 #define  ASSERT_MSG(condition, msg) \
     if((condition) == false) { log_print(msg) ; assert(false);}
@@ -25,9 +28,16 @@ int main(int argc, char **argv) {
     std::string file_path = "default";
     //file_path = "C:/Users/xmy/Desktop/TetGeo/config/default_config_s.json";
     app.add_option("-f,--file", file_path, "A help string");
+    int benchmark_triangles = 0;
+    app.add_option("--benchmark-ray-triangle", benchmark_triangles, "Benchmark the ray-triangle kernels on N random triangles and exit");
 
     CLI11_PARSE(app, argc, argv);
 
+    if (benchmark_triangles > 0) {
+        run_ray_triangle_benchmark(benchmark_triangles);
+        return 0;
+    }
+
     if (strcmp(file_path.c_str(), "default") == 0) {
         log_print("input config path is null, use current dir!");
         file_path = "./default_config.json";
@@ -50,32 +60,154 @@ int main(int argc, char **argv) {
 
     for (auto f3grid_file_path: config.input_file_path) {
         Mesh_Loader::FileData data;
-        bool res = Mesh_Loader::load_f3grid(f3grid_file_path.c_str(), data);
+        bool is_f3grid = get_file_extension(f3grid_file_path) == "f3grid";
+        if (config.streaming_conversion && is_f3grid) {
+            bool vtu_only = config.export_vtu && !config.export_six_surface && !config.export_vtkhdf && !config.export_exodus &&
+                            !config.export_gmsh && !config.export_f3grid && !config.export_preview && config.spatial_reorder == "none" &&
+                            !config.rcm_reorder;
+            if (vtu_only) {
+                std::string full_path = path_join(config.save_output_path, get_file_name(f3grid_file_path, false) + ".vtu");
+                if (Mesh_Loader::convert_f3grid_to_vtu_streaming(f3grid_file_path.c_str(), full_path.c_str(), config.stream_batch_size,
+                                                                 config.array_to_number, config.export_face_related))
+                    log_print("export vtu success in path: " + full_path);
+                else
+                    log_print("export vtu error in path: " + full_path);
+                continue;
+            }
+            log_print("streaming conversion only writes the vtu, other exports are on, load the whole mesh");
+        }
+        bool res = Mesh_Loader::load_file(f3grid_file_path.c_str(), data);
         if (res && data.numberOfPoints != 0) {
-            log_print("load frgrid file success: " + f3grid_file_path);
+            log_print("load file success: " + f3grid_file_path);
         }
         else {
-            log_print("load frgrid file error: " + f3grid_file_path);
+            log_print("load file error: " + f3grid_file_path);
             break;
         };
+        if (config.spatial_reorder != "none") {
+            reorder_by_space_filling_curve(data, config.spatial_reorder == "hilbert" ? Space_Filling_Curve::hilbert : Space_Filling_Curve::morton);
+            log_print("reorder points and cells along the " + config.spatial_reorder + " curve");
+        }
+        if (config.rcm_reorder) {
+            Bandwidth_Profile before, after;
+            reorder_by_reverse_cuthill_mckee(data, before, after);
+            log_print("reorder points by reverse Cuthill-McKee, bandwidth " + std::to_string(before.bandwidth) + " -> " +
+                      std::to_string(after.bandwidth) + ", profile " + std::to_string(before.profile) + " -> " + std::to_string(after.profile));
+        }
         std::string file_name = get_file_name(f3grid_file_path, false);
-        std::string full_path = path_join(config.save_output_path, file_name + ".vtu");
-        Mesh_Loader::save_vtu(full_path.c_str(), data);
-        log_print("export vtu success in path: " + full_path);
-
-        if (config.export_six_surface) {
-            Unwrap up;
-            if (config.export_face_related) {
-                config.export_face_related = false;
-                Mesh_Loader::FileData data_new;
-                Mesh_Loader::load_f3grid(f3grid_file_path.c_str(), data_new);
-                up.init_from_filedata(data_new);
+        //the domain file, the vtkhdf and the six surfaces only read data and are written concurrently;
+        //the exports after them wait for the pool
+        Task_Pool export_pool(config.export_io_concurrency);
+        //the bulk ids of the six surfaces index <name>.vtu, so it is written whenever they are
+        if (config.export_six_surface && !config.export_vtu)
+            log_print("export_six_surface is on, export the vtu as well");
+        if (config.export_vtu || config.export_six_surface) {
+            export_pool.submit([&data, file_name](int) {
+                std::string full_path = path_join(config.save_output_path, file_name + ".vtu");
+                if (config.update_attributes && is_file_exist(full_path) && Mesh_Loader::update_vtu_attributes(full_path.c_str(), data))
+                    log_print("update vtu attributes success in path: " + full_path);
+                else if (config.vtu_appended || config.update_attributes) {
+                    if (Mesh_Loader::save_vtu_appended(full_path.c_str(), data))
+                        log_print("export vtu success in path: " + full_path);
+                    else
+                        log_print("export vtu error in path: " + full_path);
+                }
+                else {
+                    Mesh_Loader::save_vtu(full_path.c_str(), data);
+                    log_print("export vtu success in path: " + full_path);
+                }
+            });
+        }
+        if (config.export_vtkhdf) {
+            export_pool.submit([&data, file_name](int) {
+                std::string full_path = path_join(config.save_output_path, file_name + ".vtkhdf");
+                if (Mesh_Loader::save_vtkhdf(full_path.c_str(), data, config.vtkhdf_compression_level))
+                    log_print("export vtkhdf success in path: " + full_path);
+                else
+                    log_print("export vtkhdf error in path: " + full_path);
+            });
+        }
+
+        std::vector<Mesh_Loader::FaceGroup> file_face_groups = Mesh_Loader::get_face_groups(data);
+        //the boundary topology is built once, each export job only redoes the seeds and the segmentation
+        Unwrap up;
+        if (config.export_six_surface)
+            up.init_from_filedata(data);
+        //a directory is written by its first job only: a later job for it would overwrite the same files (with the
+        //same content when only the rotation differs and the six surfaces are off), so it is skipped
+        std::vector<std::pair<std::string, const Export_Job *>> written_jobs;
+        for (const auto &job: config.export_jobs) {
+            std::string output_path = config.save_output_path;
+            if (!job.output_subdirectory.empty())
+                output_path = path_join(config.save_output_path, job.output_subdirectory);
+            auto written = std::find_if(written_jobs.begin(), written_jobs.end(), [&](const auto &w) { return w.first == output_path; });
+            if (written != written_jobs.end()) {
+                const Export_Job &first = *written->second;
+                bool same = first.export_materialids_using_slot == job.export_materialids_using_slot &&
+                            (!config.export_six_surface || (first.r_x == job.r_x && first.r_y == job.r_y && first.r_z == job.r_z));
+                if (same)
+                    log_print("skip export job, same output as an earlier job in: " + output_path);
+                else
+                    log_print("WARN: skip export job, an earlier job already writes to: " + output_path + ", set output_subdirectory");
+                continue;
+            }
+            written_jobs.emplace_back(output_path, &job);
+            if (!job.output_subdirectory.empty()) {
+                std::error_code err;
+                if (!create_directory_recursive(output_path, err)) {
+                    log_print("ERROR: can not create the output dir: " + output_path);
+                    continue;
+                }
             }
-            else {
-                up.init_from_filedata(data);
+
+            std::vector<Mesh_Loader::FaceGroup> face_groups = file_face_groups;
+            if (config.export_six_surface) {
+                up.set_tet_type(data, job.export_materialids_using_slot);
+                Unwrap_01(up, {job.r_x, job.r_y, job.r_z});
+                up.save_file(output_path, export_pool);
+                auto six_surface_groups = up.get_face_groups();
+                face_groups.insert(face_groups.end(), six_surface_groups.begin(), six_surface_groups.end());
             }
-            Unwrap_01(up);
-            up.save_file(config.save_output_path);
+            export_pool.wait(); //the patch tasks read up
+
+            if (config.export_exodus) {
+                std::string full_path = path_join(output_path, file_name + ".exo");
+                if (Mesh_Loader::save_exodus(full_path.c_str(), data, job.export_materialids_using_slot, face_groups))
+                    log_print("export exodus success in path: " + full_path);
+                else
+                    log_print("export exodus error in path: " + full_path);
+            }
+
+            if (config.export_gmsh) {
+                std::string full_path = path_join(output_path, file_name + ".msh");
+                if (Mesh_Loader::save_msh(full_path.c_str(), data, job.export_materialids_using_slot, face_groups))
+                    log_print("export msh success in path: " + full_path);
+                else
+                    log_print("export msh error in path: " + full_path);
+            }
+        }
+        export_pool.wait();
+
+        if (config.export_f3grid) {
+            std::string full_path = path_join(config.save_output_path, file_name + ".f3grid");
+            std::error_code err;
+            if (std::filesystem::equivalent(full_path, f3grid_file_path, err))
+                full_path = path_join(config.save_output_path, file_name + "_out.f3grid");
+            if (Mesh_Loader::save_f3grid(full_path.c_str(), data))
+                log_print("export f3grid success in path: " + full_path);
+            else
+                log_print("export f3grid error in path: " + full_path);
+        }
+
+        if (config.export_preview) {
+            std::string full_path = path_join(config.save_output_path, file_name + ".f3zp");
+            std::error_code err;
+            if (std::filesystem::equivalent(full_path, f3grid_file_path, err))
+                full_path = path_join(config.save_output_path, file_name + "_out.f3zp");
+            if (Mesh_Loader::save_preview(full_path.c_str(), data, config.preview_coord_tolerance, config.preview_field_tolerance))
+                log_print("export preview success in path: " + full_path);
+            else
+                log_print("export preview error in path: " + full_path);
         }
     }
 
@@ -0,0 +1,174 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <unordered_map>
+
+#include "vtk_exodusII.h"
+
+#include "mesh_loader.h"
+#include "utils/log/log.h"
+
+namespace Mesh_Loader {
+
+    namespace {
+        // exodus tet4 side (1-based) of the local face opposite to vertex k
+        const int tet_side_opposite_vertex[4] = {2, 3, 1, 4};
+
+        struct Face_Key_Hash {
+            size_t operator()(const std::array<int, 3> &k) const {
+                uint64_t h = (uint64_t) (uint32_t) k[0] * 0x9E3779B97F4A7C15ull;
+                h ^= (uint64_t) (uint32_t) k[1] + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+                h ^= (uint64_t) (uint32_t) k[2] + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+                return h;
+            }
+        };
+
+        std::array<int, 3> face_key(int a, int b, int c) {
+            std::array<int, 3> k = {a, b, c};
+            std::sort(k.begin(), k.end());
+            return k;
+        }
+
+        bool check_ex(int status, const char *what) {
+            if (status < 0) {
+                log_print("ERROR: exodus " + std::string(what) + " fail");
+                return false;
+            }
+            return true;
+        }
+    }
+
+    bool save_exodus(const char *out_file_path, const FileData &data, int material_slot, const std::vector<FaceGroup> &face_groups) {
+        //tet cells, sorted contiguously by material (counting sort keeps the file order inside a block)
+        std::vector<int> group_ids;
+        std::vector<std::string> group_names;
+        get_cell_group_ids(data, material_slot, group_ids, group_names);
+
+        int block_number = group_names.size() + 1; //last block holds the ungrouped tets
+        std::vector<int> block_size(block_number + 1, 0);
+        for (int i = 0; i < data.numberOfCell; i++) {
+            if (data.cellList[i].numberOfPoints != 4)
+                continue;
+            int b = group_ids[i] >= 0 ? group_ids[i] : block_number - 1;
+            block_size[b + 1]++;
+        }
+        std::vector<int> block_offset(block_number + 1, 0);
+        for (int b = 0; b < block_number; b++)
+            block_offset[b + 1] = block_offset[b] + block_size[b + 1];
+        int ntets = block_offset[block_number];
+
+        std::vector<int> elem_to_cell(ntets);
+        {
+            std::vector<int> cursor(block_offset.begin(), block_offset.end() - 1);
+            for (int i = 0; i < data.numberOfCell; i++) {
+                if (data.cellList[i].numberOfPoints != 4)
+                    continue;
+                int b = group_ids[i] >= 0 ? group_ids[i] : block_number - 1;
+                int e = cursor[b]++;
+                elem_to_cell[e] = i;
+            }
+        }
+
+        //side sets: resolve each triangle to (element, side) with a face hash over the tets
+        std::vector<std::vector<int>> side_elem(face_groups.size());
+        std::vector<std::vector<int>> side_side(face_groups.size());
+        if (!face_groups.empty()) {
+            std::unordered_map<std::array<int, 3>, std::pair<int, int>, Face_Key_Hash> face_map;
+            for (const auto &g: face_groups) {
+                for (int j = 0; j + 2 < g.pointList.size(); j += 3)
+                    face_map[face_key(g.pointList[j], g.pointList[j + 1], g.pointList[j + 2])] = {-1, 0};
+            }
+            for (int e = 0; e < ntets; e++) {
+                const int *p = data.cellList[elem_to_cell[e]].pointList;
+                for (int k = 0; k < 4; k++) {
+                    auto iter = face_map.find(face_key(p[(k + 1) % 4], p[(k + 2) % 4], p[(k + 3) % 4]));
+                    if (iter != face_map.end() && iter->second.first < 0)
+                        iter->second = {e + 1, tet_side_opposite_vertex[k]};
+                }
+            }
+            for (int i = 0; i < face_groups.size(); i++) {
+                const auto &g = face_groups[i];
+                int missing = 0;
+                for (int j = 0; j + 2 < g.pointList.size(); j += 3) {
+                    const auto &es = face_map[face_key(g.pointList[j], g.pointList[j + 1], g.pointList[j + 2])];
+                    if (es.first < 0) {
+                        missing++;
+                        continue;
+                    }
+                    side_elem[i].push_back(es.first);
+                    side_side[i].push_back(es.second);
+                }
+                if (missing != 0)
+                    log_print("WARN: " + std::to_string(missing) + " faces of group " + g.name + " are not tet faces, skip");
+            }
+        }
+
+        int comp_ws = sizeof(double);
+        int io_ws = sizeof(double);
+        int exoid = ex_create(out_file_path, EX_CLOBBER, &comp_ws, &io_ws);
+        if (exoid < 0) {
+            log_print("ERROR: can not create exodus file: " + std::string(out_file_path));
+            return false;
+        }
+        ex_set_max_name_length(exoid, 80);
+
+        int used_block_number = 0;
+        for (int b = 0; b < block_number; b++)
+            used_block_number += block_size[b + 1] > 0;
+
+        bool res = check_ex(ex_put_init(exoid, get_file_name(out_file_path).c_str(), 3, data.numberOfPoints, ntets,
+                                        used_block_number, 0, face_groups.size()), "put init");
+
+        if (res) {
+            std::vector<double> x(data.numberOfPoints), y(data.numberOfPoints), z(data.numberOfPoints);
+            for (int i = 0; i < data.numberOfPoints; i++) {
+                x[i] = data.pointList[i * 3];
+                y[i] = data.pointList[i * 3 + 1];
+                z[i] = data.pointList[i * 3 + 2];
+            }
+            res = check_ex(ex_put_coord(exoid, x.data(), y.data(), z.data()), "put coord");
+        }
+
+        //one bulk connectivity write per block
+        std::vector<int> conn;
+        for (int b = 0, block_id = 1; res && b < block_number; b++) {
+            int size = block_size[b + 1];
+            if (size == 0)
+                continue;
+            conn.resize(size * 4);
+            for (int e = 0; e < size; e++) {
+                const int *p = data.cellList[elem_to_cell[block_offset[b] + e]].pointList;
+                conn[e * 4] = p[0] + 1;
+                conn[e * 4 + 1] = p[1] + 1;
+                conn[e * 4 + 2] = p[2] + 1;
+                conn[e * 4 + 3] = p[3] + 1;
+            }
+            std::string name = b < group_names.size() ? group_names[b] : "ungrouped";
+            res = check_ex(ex_put_block(exoid, EX_ELEM_BLOCK, block_id, "TETRA4", size, 4, 0, 0, 0), "put block") &&
+                  check_ex(ex_put_conn(exoid, EX_ELEM_BLOCK, block_id, conn.data(), nullptr, nullptr), "put conn") &&
+                  check_ex(ex_put_name(exoid, EX_ELEM_BLOCK, block_id, name.c_str()), "put block name");
+            block_id++;
+        }
+
+        //element id map keeps the original (1-based) cell index
+        if (res) {
+            std::vector<int> id_map(ntets);
+            for (int e = 0; e < ntets; e++)
+                id_map[e] = elem_to_cell[e] + 1;
+            res = check_ex(ex_put_id_map(exoid, EX_ELEM_MAP, id_map.data()), "put element id map");
+        }
+
+        for (int i = 0; res && i < face_groups.size(); i++) {
+            int set_id = i + 1;
+            res = check_ex(ex_put_set_param(exoid, EX_SIDE_SET, set_id, side_elem[i].size(), 0), "put side set param") &&
+                  check_ex(ex_put_set(exoid, EX_SIDE_SET, set_id, side_elem[i].data(), side_side[i].data()), "put side set") &&
+                  check_ex(ex_put_name(exoid, EX_SIDE_SET, set_id, face_groups[i].name.c_str()), "put side set name");
+        }
+
+        ex_close(exoid);
+        return res;
+    }
+
+}
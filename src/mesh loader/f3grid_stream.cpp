@@ -0,0 +1,430 @@
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+#include <vtkCellType.h>
+
+#include "mesh_loader.h"
+#include "vtu_xml.h"
+#include "utils/log/log.h"
+#include "utils/string/string_utils.h"
+
+// f3grid -> vtu conversion that never holds the mesh in memory:
+//   pass 1 parses the f3grid once, spilling points / connectivity / cell types / group members to temp files
+//   in batches, pass 2 resolves every group slot to a per cell value, window by window (bucketed by cell index),
+//   then the vtu is assembled as raw appended data by copying the temp files in batches.
+// Cells, slot array names and values are the same as load_f3grid + save_vtu produce.
+namespace Mesh_Loader {
+
+    namespace {
+        //buffered binary spill file
+        struct Spill_File {
+            Spill_File() = default;
+
+            Spill_File(const Spill_File &) = delete;
+
+            std::string path;
+            FILE *fp = nullptr;
+            std::vector<char> buffer;
+            size_t limit = 0;
+            uint64_t bytes = 0;
+
+            bool open(const std::string &p, size_t batch_bytes) {
+                path = p;
+                limit = batch_bytes;
+                buffer.reserve(limit);
+                fp = fopen(path.c_str(), "wb+");
+                return fp != nullptr;
+            }
+
+            template<typename T>
+            void write(const T &value) {
+                if (buffer.size() + sizeof(T) > limit)
+                    flush();
+                const char *p = (const char *) &value;
+                buffer.insert(buffer.end(), p, p + sizeof(T));
+                bytes += sizeof(T);
+            }
+
+            void flush() {
+                if (!buffer.empty())
+                    fwrite(buffer.data(), 1, buffer.size(), fp);
+                buffer.clear();
+            }
+
+            //switch to reading from the beginning
+            void rewind_for_read() {
+                flush();
+                fflush(fp);
+                fseek(fp, 0, SEEK_SET);
+            }
+
+            void close_and_remove() {
+                if (fp != nullptr) {
+                    fclose(fp);
+                    fp = nullptr;
+                    std::remove(path.c_str());
+                }
+            }
+
+            ~Spill_File() { close_and_remove(); }
+        };
+
+        struct Stream_Slot {
+            std::string name;                       //array name, "<slot>_Z" or "<slot>_F"
+            bool face = false;                      //members are triangle indices
+            std::map<std::string, int> group_id;    //group name -> id in discovery order
+            std::vector<std::string> group_names;   //by discovery id
+            Spill_File members;                     //(member index, discovery id) int32 pairs
+            Spill_File values;                      //resolved int32 per cell, -1 none (sorted group rank)
+            std::vector<int> rank;                  //discovery id -> sorted rank (load_f3grid numbering)
+            std::vector<uint64_t> rank_count;       //cells per rank after resolving
+            uint64_t none_count = 0;
+        };
+
+        //tets and triangles appear in runs, the k-th tet (or triangle) is found by a binary search over its runs
+        struct Cell_Run {
+            int64_t kind_begin;
+            int64_t cell_begin;
+        };
+
+        int64_t kind_to_cell(const std::vector<Cell_Run> &runs, int64_t k, int64_t kind_number) {
+            if (k < 0 || k >= kind_number)
+                return -1;
+            auto iter = std::upper_bound(runs.begin(), runs.end(), k, [](int64_t v, const Cell_Run &r) { return v < r.kind_begin; });
+            --iter;
+            return iter->cell_begin + (k - iter->kind_begin);
+        }
+
+        bool copy_file_bytes(Spill_File &from, FILE *to, uint64_t bytes, std::vector<char> &chunk) {
+            from.rewind_for_read();
+            while (bytes > 0) {
+                size_t n = std::min<uint64_t>(bytes, chunk.size());
+                if (fread(chunk.data(), 1, n, from.fp) != n)
+                    return false;
+                fwrite(chunk.data(), 1, n, to);
+                bytes -= n;
+            }
+            return true;
+        }
+    }
+
+    bool convert_f3grid_to_vtu_streaming(const char *in_file_path, const char *out_file_path, size_t batch_size,
+                                         bool array_to_number, bool face_related) {
+        batch_size = std::max<size_t>(batch_size, 1024);
+        FILE *fp = fopen(in_file_path, "r");
+        if (fp == (FILE *) NULL) {
+            log_print("ERROR: can not open f3grid file: " + std::string(in_file_path));
+            return false;
+        }
+
+        std::string temp_base = std::string(out_file_path) + ".tmp";
+        Spill_File points, connectivity, types;
+        if (!points.open(temp_base + ".points", batch_size * 24) || !connectivity.open(temp_base + ".connectivity", batch_size * 32) ||
+            !types.open(temp_base + ".types", batch_size)) {
+            log_print("ERROR: can not create temp file: " + temp_base);
+            fclose(fp);
+            return false;
+        }
+
+        //pass 1
+        int64_t nverts = 0, ntetrahedras = 0, ntriangles = 0, ncells = 0, nids = 0;
+        std::vector<Cell_Run> runs[2]; //tet runs, triangle runs
+        bool last_triangle = false;
+        std::map<std::string, Stream_Slot> slots;
+        Stream_Slot *current_slot = nullptr;
+        int current_group = -1;
+        bool res = true;
+
+        char buffer[2048];
+        while (res && fgets(buffer, sizeof(buffer), fp) != NULL) {
+            char *p = buffer;
+            if (*p == ' ' && current_slot != nullptr) {
+                //group members, 1-based tet or triangle index
+                char *end;
+                for (long index = strtol(p, &end, 10); end != p; index = strtol(p, &end, 10)) {
+                    current_slot->members.write((int32_t) (index - 1));
+                    current_slot->members.write((int32_t) current_group);
+                    p = end;
+                }
+                continue;
+            }
+            while (*p == ' ' || *p == '\t')
+                p++;
+            if (*p == '\0' || *p == '\r' || *p == '\n')
+                continue;
+            current_slot = nullptr;
+
+            bool tet = strncmp(p, "Z T4", 4) == 0;
+            bool triangle = strncmp(p, "F T3", 4) == 0;
+            if (p[0] == 'G' && (p[1] == ' ' || p[1] == '\t')) {
+                char *end;
+                strtol(p + 1, &end, 10);
+                for (int k = 0; k < 3; k++)
+                    points.write(strtod(end, &end));
+                nverts++;
+            }
+            else if (tet || (triangle && face_related)) {
+                char *end;
+                strtol(p + 4, &end, 10);
+                int n = tet ? 4 : 3;
+                for (int k = 0; k < n; k++)
+                    connectivity.write((int64_t) strtol(end, &end, 10) - 1);
+                types.write((uint8_t) (tet ? VTK_TETRA : VTK_TRIANGLE));
+                if (ncells == 0 || last_triangle != triangle)
+                    runs[triangle].push_back({triangle ? ntriangles : ntetrahedras, ncells});
+                last_triangle = triangle;
+                (tet ? ntetrahedras : ntriangles)++;
+                ncells++;
+                nids += n;
+            }
+            else if (strncmp(p, "ZGROUP", 6) == 0 || (strncmp(p, "FGROUP", 6) == 0 && face_related)) {
+                bool face = p[0] == 'F';
+                auto split_res = string_split(p, " ");
+                if (split_res.size() < 4) {
+                    log_print("ERROR: broken group line: " + std::string(p));
+                    res = false;
+                    break;
+                }
+                auto s_1 = string_shrink(split_res[1]);
+                auto s_3 = string_shrink(split_res[3]) + (face ? "_F" : "_Z");
+                auto iter = slots.find(s_3);
+                if (iter == slots.end()) {
+                    iter = slots.try_emplace(s_3).first;
+                    iter->second.name = s_3;
+                    iter->second.face = face;
+                    std::string safe_name = std::to_string(slots.size());
+                    if (!iter->second.members.open(temp_base + ".slot" + safe_name, batch_size * 8) ||
+                        !iter->second.values.open(temp_base + ".values" + safe_name, batch_size * 4)) {
+                        log_print("ERROR: can not create temp file: " + temp_base);
+                        res = false;
+                        break;
+                    }
+                }
+                current_slot = &iter->second;
+                auto group_iter = current_slot->group_id.find(s_1);
+                if (group_iter == current_slot->group_id.end()) {
+                    group_iter = current_slot->group_id.emplace(s_1, current_slot->group_names.size()).first;
+                    current_slot->group_names.push_back(s_1);
+                }
+                current_group = group_iter->second;
+            }
+        }
+        fclose(fp);
+        if (!res)
+            return false;
+
+        //pass 2: members -> per cell values, in windows of batch_size cells
+        std::vector<char> chunk(batch_size * 8);
+        for (auto &item: slots) {
+            Stream_Slot &slot = item.second;
+            slot.rank.resize(slot.group_names.size());
+            {
+                int r = 0;
+                for (auto &group: slot.group_id)
+                    slot.rank[group.second] = r++;
+            }
+            slot.rank_count.assign(slot.group_names.size(), 0);
+
+            //bucket the pairs by cell window (a single bucket needs no redistribution)
+            int64_t window_number = std::max<int64_t>(1, (ncells + batch_size - 1) / batch_size);
+            std::vector<Spill_File> buckets(window_number > 1 ? window_number : 0);
+            for (int64_t w = 0; w < buckets.size(); w++) {
+                if (!buckets[w].open(slot.members.path + "." + std::to_string(w), std::max<size_t>(batch_size * 8 / window_number, 4096))) {
+                    log_print("ERROR: can not create temp file: " + slot.members.path);
+                    return false;
+                }
+            }
+            int64_t kind_number = slot.face ? ntriangles : ntetrahedras;
+            auto read_pairs = [&](Spill_File &file, uint64_t bytes, auto &&on_pair) {
+                file.rewind_for_read();
+                std::vector<int32_t> pairs(batch_size * 2);
+                while (bytes > 0) {
+                    size_t n = std::min<uint64_t>(bytes, pairs.size() * sizeof(int32_t));
+                    if (fread(pairs.data(), 1, n, file.fp) != n)
+                        return false;
+                    for (size_t i = 0; i < n / sizeof(int32_t); i += 2)
+                        on_pair(pairs[i], pairs[i + 1]);
+                    bytes -= n;
+                }
+                return true;
+            };
+            if (window_number > 1) {
+                res = read_pairs(slot.members, slot.members.bytes, [&](int32_t member, int32_t group) {
+                    int64_t cell = kind_to_cell(runs[slot.face], member, kind_number);
+                    if (cell < 0)
+                        return;
+                    auto &bucket = buckets[cell / batch_size];
+                    bucket.write((int32_t) cell);
+                    bucket.write(group);
+                });
+                slot.members.close_and_remove();
+            }
+
+            std::vector<int32_t> window(batch_size);
+            for (int64_t w = 0; res && w < window_number; w++) {
+                int64_t begin = w * batch_size;
+                int64_t end = std::min<int64_t>(ncells, begin + batch_size);
+                std::fill(window.begin(), window.begin() + (end - begin), -1);
+                //the last group in sorted order wins, like load_f3grid
+                if (window_number > 1) {
+                    res = read_pairs(buckets[w], buckets[w].bytes, [&](int32_t cell, int32_t group) {
+                        int32_t &v = window[cell - begin];
+                        v = std::max(v, (int32_t) slot.rank[group]);
+                    });
+                    buckets[w].close_and_remove();
+                }
+                else {
+                    res = read_pairs(slot.members, slot.members.bytes, [&](int32_t member, int32_t group) {
+                        int64_t cell = kind_to_cell(runs[slot.face], member, kind_number);
+                        if (cell < 0)
+                            return;
+                        int32_t &v = window[cell];
+                        v = std::max(v, (int32_t) slot.rank[group]);
+                    });
+                }
+                for (int64_t c = 0; c < end - begin; c++) {
+                    if (window[c] >= 0)
+                        slot.rank_count[window[c]]++;
+                    else
+                        slot.none_count++;
+                    slot.values.write(window[c]);
+                }
+            }
+            slot.members.close_and_remove();
+            if (!res) {
+                log_print("ERROR: can not read temp file: " + slot.members.path);
+                return false;
+            }
+        }
+
+        //assemble: every appended block is a UInt64 byte count + raw bytes
+        std::vector<uint64_t> slot_bytes;
+        for (auto &item: slots) {
+            Stream_Slot &slot = item.second;
+            if (array_to_number) {
+                slot_bytes.push_back(ncells * sizeof(int32_t));
+            }
+            else {
+                uint64_t bytes = slot.none_count;
+                for (int g = 0; g < slot.group_names.size(); g++)
+                    bytes += slot.rank_count[slot.rank[g]] * (slot.group_names[g].size() + 1);
+                slot_bytes.push_back(bytes);
+            }
+        }
+        uint64_t points_bytes = nverts * 3 * sizeof(double);
+        uint64_t connectivity_bytes = nids * sizeof(int64_t);
+        uint64_t offsets_bytes = ncells * sizeof(int64_t);
+        uint64_t types_bytes = ncells;
+
+        FILE *out = fopen(out_file_path, "wb");
+        if (out == (FILE *) NULL) {
+            log_print("ERROR: can not create vtu file: " + std::string(out_file_path));
+            return false;
+        }
+
+        uint64_t offset = 0;
+        auto appended_array = [&](const char *type, const std::string &name, int components, uint64_t bytes) {
+            fputs(vtu_appended_array(type, name, components, offset).c_str(), out);
+            offset += sizeof(uint64_t) + bytes;
+        };
+
+        fputs(vtu_file_begin().c_str(), out);
+        fputs(vtu_piece_begin(nverts, ncells).c_str(), out);
+        fprintf(out, "      <PointData>\n      </PointData>\n");
+        fprintf(out, "      <CellData>\n");
+        {
+            int s = 0;
+            for (auto &item: slots)
+                appended_array(array_to_number ? "Int32" : "String", item.first, 1, slot_bytes[s++]);
+        }
+        fprintf(out, "      </CellData>\n");
+        fprintf(out, "      <Points>\n");
+        appended_array("Float64", "Points", 3, points_bytes);
+        fprintf(out, "      </Points>\n");
+        fprintf(out, "      <Cells>\n");
+        appended_array("Int64", "connectivity", 1, connectivity_bytes);
+        appended_array("Int64", "offsets", 1, offsets_bytes);
+        appended_array("UInt8", "types", 1, types_bytes);
+        fprintf(out, "      </Cells>\n");
+        fputs(vtu_piece_end().c_str(), out);
+        fputs(vtu_appended_marker, out);
+
+        {
+            int s = 0;
+            std::vector<int32_t> values(batch_size);
+            std::string text;
+            for (auto &item: slots) {
+                Stream_Slot &slot = item.second;
+                fwrite(&slot_bytes[s], sizeof(uint64_t), 1, out);
+                if (array_to_number) {
+                    res &= copy_file_bytes(slot.values, out, slot_bytes[s], chunk);
+                }
+                else {
+                    std::vector<std::string> name_by_rank(slot.group_names.size());
+                    for (int g = 0; g < slot.group_names.size(); g++)
+                        name_by_rank[slot.rank[g]] = slot.group_names[g];
+                    slot.values.rewind_for_read();
+                    for (int64_t c = 0; res && c < ncells; c += batch_size) {
+                        size_t n = std::min<int64_t>(batch_size, ncells - c);
+                        res = fread(values.data(), sizeof(int32_t), n, slot.values.fp) == n;
+                        text.clear();
+                        for (size_t i = 0; res && i < n; i++) {
+                            if (values[i] >= 0)
+                                text += name_by_rank[values[i]];
+                            text += '\0';
+                        }
+                        fwrite(text.data(), 1, text.size(), out);
+                    }
+                }
+                slot.values.close_and_remove();
+                s++;
+            }
+        }
+
+        fwrite(&points_bytes, sizeof(uint64_t), 1, out);
+        res &= copy_file_bytes(points, out, points_bytes, chunk);
+        fwrite(&connectivity_bytes, sizeof(uint64_t), 1, out);
+        res &= copy_file_bytes(connectivity, out, connectivity_bytes, chunk);
+
+        //offsets are rebuilt from the cell types
+        fwrite(&offsets_bytes, sizeof(uint64_t), 1, out);
+        {
+            types.rewind_for_read();
+            std::vector<uint8_t> type_batch(batch_size);
+            std::vector<int64_t> offset_batch(batch_size);
+            int64_t cell_offset = 0;
+            for (int64_t c = 0; res && c < ncells; c += batch_size) {
+                size_t n = std::min<int64_t>(batch_size, ncells - c);
+                res = fread(type_batch.data(), 1, n, types.fp) == n;
+                for (size_t i = 0; i < n; i++) {
+                    cell_offset += type_batch[i] == VTK_TETRA ? 4 : 3;
+                    offset_batch[i] = cell_offset;
+                }
+                fwrite(offset_batch.data(), sizeof(int64_t), n, out);
+            }
+        }
+        fwrite(&types_bytes, sizeof(uint64_t), 1, out);
+        res &= copy_file_bytes(types, out, types_bytes, chunk);
+
+        fputs(vtu_appended_trailer, out);
+        res &= ferror(out) == 0;
+        fclose(out);
+
+        if (!res) {
+            log_print("ERROR: streaming conversion fail: " + std::string(out_file_path));
+            return false;
+        }
+        log_print("* streaming f3grid -> vtu success!");
+        log_print("* tetrahedra number: " + std::to_string(ntetrahedras));
+        log_print("* triangle number: " + std::to_string(ntriangles));
+        log_print("* GROUP SLOT number: " + std::to_string(slots.size()));
+        return true;
+    }
+
+}
@@ -0,0 +1,270 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <initializer_list>
+
+#include "mesh_loader.h"
+#include "utils/log/log.h"
+#include "utils/string/fast_format.h"
+
+// FLAC3D f3grid writer, the inverse of load_f3grid:
+//   int/string cell arrays named "<slot>_Z" -> ZGROUP over the tetrahedra,
+//   int/string cell arrays named "<slot>_F" -> FGROUP over the triangles,
+//   int/string point arrays named "<slot>_G" -> GGROUP.
+// Arrays with other names (MaterialIDs, arrays of a vtu input, ...) are not groups and are skipped.
+// Ids in the file are 1-based and numbered separately for gridpoints, zones and faces.
+namespace Mesh_Loader {
+
+    namespace {
+        const int f3grid_ids_per_line = 10;
+
+        struct Group_Slot {
+            std::string slot_name;
+            std::vector<std::string> group_names;
+            std::vector<int> group_offset; //CSR over members
+            std::vector<int> members;      //1-based ids
+        };
+
+        bool has_suffix(const std::string &name, const char *suffix) {
+            return name.size() > 2 && name.compare(name.size() - 2, 2, suffix) == 0;
+        }
+
+        std::string strip_suffix(const std::string &name, const char *suffix) {
+            if (has_suffix(name, suffix))
+                return name.substr(0, name.size() - 2);
+            return name;
+        }
+
+        //the arrays named "<slot><suffix>"; when cell_points > 0 the cells of the other kind are set to no_group
+        template<typename T>
+        std::map<std::string, DataArray<T>> select_slots(const std::map<std::string, DataArray<T>> &arrays, const char *suffix,
+                                                          const FileData &data, int cell_points, const T &no_group) {
+            std::map<std::string, DataArray<T>> res;
+            for (auto iter = arrays.begin(); iter != arrays.end(); iter++) {
+                if (!has_suffix(iter->first, suffix))
+                    continue;
+                auto &target = res[iter->first].content;
+                target = iter->second.content;
+                for (int i = 0; cell_points > 0 && i < data.numberOfCell; i++) {
+                    if (data.cellList[i].numberOfPoints != cell_points)
+                        target[i] = no_group;
+                }
+            }
+            return res;
+        }
+
+        template<typename T>
+        void warn_not_slots(const std::map<std::string, DataArray<T>> &arrays, const char *kind,
+                            std::initializer_list<const char *> suffixes) {
+            for (auto iter = arrays.begin(); iter != arrays.end(); iter++) {
+                bool slot = false;
+                for (const char *suffix: suffixes)
+                    slot |= has_suffix(iter->first, suffix);
+                if (!slot)
+                    log_print("WARN: f3grid " + std::string(kind) + " array " + iter->first + " is not a group slot, skip");
+            }
+        }
+
+        // group_of(i) returns the compact group index of entity i or -1, entity_id(i) its 1-based id in the file
+        template<typename GroupOf, typename EntityId>
+        void build_slot(Group_Slot &slot, int entity_number, int group_number, GroupOf group_of, EntityId entity_id) {
+            slot.group_offset.assign(group_number + 1, 0);
+            for (int i = 0; i < entity_number; i++) {
+                int g = group_of(i);
+                if (g >= 0)
+                    slot.group_offset[g + 1]++;
+            }
+            for (int g = 0; g < group_number; g++)
+                slot.group_offset[g + 1] += slot.group_offset[g];
+            slot.members.resize(slot.group_offset[group_number]);
+            std::vector<int> cursor(slot.group_offset.begin(), slot.group_offset.end() - 1);
+            for (int i = 0; i < entity_number; i++) {
+                int g = group_of(i);
+                if (g >= 0)
+                    slot.members[cursor[g]++] = entity_id(i);
+            }
+        }
+
+        template<typename EntityId>
+        void collect_slots(std::vector<Group_Slot> &slots, const char *suffix, int entity_number,
+                           const std::map<std::string, DataArray<int>> &int_arrays,
+                           const std::map<std::string, DataArray<std::string>> &string_arrays,
+                           EntityId entity_id) {
+            for (auto iter = int_arrays.begin(); iter != int_arrays.end(); iter++) {
+                const auto &content = iter->second.content;
+                std::map<int, int> number_map;
+                for (int i = 0; i < entity_number; i++) {
+                    if (content[i] >= 0)
+                        number_map[content[i]];
+                }
+                Group_Slot slot;
+                slot.slot_name = strip_suffix(iter->first, suffix);
+                for (auto &item: number_map) {
+                    item.second = slot.group_names.size();
+                    slot.group_names.push_back(std::to_string(item.first));
+                }
+                std::vector<int> group_index(entity_number, -1);
+                for (int i = 0; i < entity_number; i++) {
+                    if (content[i] >= 0)
+                        group_index[i] = number_map[content[i]];
+                }
+                build_slot(slot, entity_number, slot.group_names.size(), [&](int i) { return group_index[i]; }, entity_id);
+                slots.push_back(std::move(slot));
+            }
+            for (auto iter = string_arrays.begin(); iter != string_arrays.end(); iter++) {
+                const auto &content = iter->second.content;
+                std::map<std::string, int> name_map;
+                for (int i = 0; i < entity_number; i++) {
+                    if (!content[i].empty())
+                        name_map[content[i]];
+                }
+                Group_Slot slot;
+                slot.slot_name = strip_suffix(iter->first, suffix);
+                for (auto &item: name_map) {
+                    item.second = slot.group_names.size();
+                    slot.group_names.push_back(item.first);
+                }
+                std::vector<int> group_index(entity_number, -1);
+                for (int i = 0; i < entity_number; i++) {
+                    if (!content[i].empty())
+                        group_index[i] = name_map[content[i]];
+                }
+                build_slot(slot, entity_number, slot.group_names.size(), [&](int i) { return group_index[i]; }, entity_id);
+                slots.push_back(std::move(slot));
+            }
+        }
+
+        bool write_groups(FILE *fp, const char *keyword, const std::vector<Group_Slot> &slots) {
+            bool res = true;
+            for (const auto &slot: slots) {
+                for (int g = 0; g < slot.group_names.size(); g++) {
+                    int begin = slot.group_offset[g];
+                    int number = slot.group_offset[g + 1] - begin;
+                    if (number == 0)
+                        continue;
+                    fprintf(fp, "%s \"%s\" SLOT \"%s\"\n", keyword, slot.group_names[g].c_str(), slot.slot_name.c_str());
+                    int lines = (number + f3grid_ids_per_line - 1) / f3grid_ids_per_line;
+                    const int *members = &slot.members[begin];
+                    res &= write_text_parallel(fp, lines, f3grid_ids_per_line * (max_int_chars + 1) + 1, [=](char *p, size_t l) {
+                        int b = l * f3grid_ids_per_line;
+                        int e = std::min(number, b + f3grid_ids_per_line);
+                        for (int k = b; k < e; k++) {
+                            *p++ = ' ';
+                            p = format_int(p, members[k]);
+                        }
+                        *p++ = '\n';
+                        return p;
+                    });
+                }
+            }
+            return res;
+        }
+    }
+
+    bool save_f3grid(const char *out_file_path, const FileData &data) {
+        //zones and faces are numbered separately
+        std::vector<int> cell_file_id(data.numberOfCell);
+        std::vector<int> tet_cells, triangle_cells;
+        for (int i = 0; i < data.numberOfCell; i++) {
+            const Cell &cell = data.cellList[i];
+            if (cell.numberOfPoints == 4) {
+                tet_cells.push_back(i);
+                cell_file_id[i] = tet_cells.size();
+            }
+            else if (cell.numberOfPoints == 3) {
+                triangle_cells.push_back(i);
+                cell_file_id[i] = triangle_cells.size();
+            }
+            else {
+                log_print("ERROR: unsupport input");
+                return false;
+            }
+        }
+
+        auto cell_id = [&](int i) { return cell_file_id[i]; };
+        auto point_id = [](int i) { return i + 1; };
+
+        //group ids of cells of the other kind are ignored
+        std::vector<Group_Slot> z_slots, f_slots, g_slots;
+        collect_slots(z_slots, "_Z", data.numberOfCell, select_slots(data.cellDataInt, "_Z", data, 4, -1),
+                      select_slots(data.cellDataString, "_Z", data, 4, std::string()), cell_id);
+        collect_slots(f_slots, "_F", data.numberOfCell, select_slots(data.cellDataInt, "_F", data, 3, -1),
+                      select_slots(data.cellDataString, "_F", data, 3, std::string()), cell_id);
+        collect_slots(g_slots, "_G", data.numberOfPoints, select_slots(data.pointDataInt, "_G", data, 0, -1),
+                      select_slots(data.pointDataString, "_G", data, 0, std::string()), point_id);
+        warn_not_slots(data.cellDataInt, "cell", {"_Z", "_F"});
+        warn_not_slots(data.cellDataString, "cell", {"_Z", "_F"});
+        warn_not_slots(data.pointDataInt, "point", {"_G"});
+        warn_not_slots(data.pointDataString, "point", {"_G"});
+
+        FILE *fp = fopen(out_file_path, "wb");
+        if (fp == (FILE *) NULL) {
+            log_print("ERROR: can not create f3grid file: " + std::string(out_file_path));
+            return false;
+        }
+
+        bool res = true;
+        fprintf(fp, "* FLAC3D grid produced by f3grid_converter\n");
+        fprintf(fp, "* GRIDPOINTS\n");
+        res &= write_text_parallel(fp, data.numberOfPoints, 4 + max_int_chars + 3 * (max_double_chars + 1), [&data](char *p, size_t i) {
+            *p++ = 'G';
+            *p++ = ' ';
+            p = format_int(p, i + 1);
+            for (int k = 0; k < 3; k++) {
+                *p++ = ' ';
+                p = format_double(p, data.pointList[i * 3 + k]);
+            }
+            *p++ = '\n';
+            return p;
+        });
+
+        fprintf(fp, "* ZONES\n");
+        res &= write_text_parallel(fp, tet_cells.size(), 7 + 5 * (max_int_chars + 1), [&](char *p, size_t i) {
+            const int *point_list = data.cellList[tet_cells[i]].pointList;
+            memcpy(p, "Z T4 ", 5);
+            p = format_int(p + 5, i + 1);
+            for (int k = 0; k < 4; k++) {
+                *p++ = ' ';
+                p = format_int(p, point_list[k] + 1);
+            }
+            *p++ = '\n';
+            return p;
+        });
+
+        if (!triangle_cells.empty()) {
+            fprintf(fp, "* FACES\n");
+            res &= write_text_parallel(fp, triangle_cells.size(), 7 + 4 * (max_int_chars + 1), [&](char *p, size_t i) {
+                const int *point_list = data.cellList[triangle_cells[i]].pointList;
+                memcpy(p, "F T3 ", 5);
+                p = format_int(p + 5, i + 1);
+                for (int k = 0; k < 3; k++) {
+                    *p++ = ' ';
+                    p = format_int(p, point_list[k] + 1);
+                }
+                *p++ = '\n';
+                return p;
+            });
+        }
+
+        if (!z_slots.empty()) {
+            fprintf(fp, "* ZONE GROUPS\n");
+            res &= write_groups(fp, "ZGROUP", z_slots);
+        }
+        if (!f_slots.empty()) {
+            fprintf(fp, "* FACE GROUPS\n");
+            res &= write_groups(fp, "FGROUP", f_slots);
+        }
+        if (!g_slots.empty()) {
+            fprintf(fp, "* GRIDPOINT GROUPS\n");
+            res &= write_groups(fp, "GGROUP", g_slots);
+        }
+
+        res &= ferror(fp) == 0;
+        fclose(fp);
+        return res;
+    }
+
+}
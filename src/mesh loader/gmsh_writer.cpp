@@ -0,0 +1,190 @@
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <limits>
+
+#include "mesh_loader.h"
+#include "utils/log/log.h"
+
+// Gmsh MSH 4.1 binary (data-size 8): $MeshFormat and $PhysicalNames are text, $Entities, $Nodes and
+// $Elements are little-endian binary blocks written with one fwrite per array.
+namespace Mesh_Loader {
+
+    namespace {
+        const int msh_type_triangle = 2;
+        const int msh_type_tetrahedron = 4;
+
+        struct Msh_Entity {
+            int dim;
+            int tag;
+            std::string name;
+            std::array<double, 6> bbox;
+            std::vector<size_t> elements; //tag, node tags ... (flattened)
+            size_t element_number = 0;
+        };
+
+        template<typename T>
+        void write_binary(FILE *fp, const T &value) {
+            fwrite(&value, sizeof(T), 1, fp);
+        }
+
+        template<typename T>
+        void write_binary(FILE *fp, const std::vector<T> &values) {
+            if (!values.empty())
+                fwrite(values.data(), sizeof(T), values.size(), fp);
+        }
+
+        void bbox_init(std::array<double, 6> &bbox) {
+            for (int k = 0; k < 3; k++) {
+                bbox[k] = std::numeric_limits<double>::max();
+                bbox[k + 3] = -std::numeric_limits<double>::max();
+            }
+        }
+
+        void bbox_add(std::array<double, 6> &bbox, const double *p) {
+            for (int k = 0; k < 3; k++) {
+                bbox[k] = std::min(bbox[k], p[k]);
+                bbox[k + 3] = std::max(bbox[k + 3], p[k]);
+            }
+        }
+    }
+
+    bool save_msh(const char *out_file_path, const FileData &data, int material_slot, const std::vector<FaceGroup> &face_groups) {
+        std::vector<int> group_ids;
+        std::vector<std::string> group_names;
+        get_cell_group_ids(data, material_slot, group_ids, group_names);
+
+        //volume entity per material, ungrouped tets go to the last one
+        std::vector<Msh_Entity> volumes(group_names.size() + 1);
+        for (int b = 0; b < volumes.size(); b++) {
+            volumes[b].dim = 3;
+            volumes[b].name = b < group_names.size() ? group_names[b] : "ungrouped";
+            bbox_init(volumes[b].bbox);
+        }
+        size_t element_tag = 1;
+        for (int i = 0; i < data.numberOfCell; i++) {
+            const Cell &cell = data.cellList[i];
+            if (cell.numberOfPoints != 4)
+                continue;
+            auto &v = volumes[group_ids[i] >= 0 ? group_ids[i] : volumes.size() - 1];
+            v.element_number++;
+        }
+        for (auto &v: volumes)
+            v.elements.reserve(v.element_number * 5);
+        for (int i = 0; i < data.numberOfCell; i++) {
+            const Cell &cell = data.cellList[i];
+            if (cell.numberOfPoints != 4)
+                continue;
+            auto &v = volumes[group_ids[i] >= 0 ? group_ids[i] : volumes.size() - 1];
+            v.elements.push_back(0);
+            for (int k = 0; k < 4; k++) {
+                v.elements.push_back(cell.pointList[k] + 1);
+                bbox_add(v.bbox, &data.pointList[cell.pointList[k] * 3]);
+            }
+        }
+        volumes.erase(std::remove_if(volumes.begin(), volumes.end(), [](const Msh_Entity &v) { return v.element_number == 0; }), volumes.end());
+        for (int b = 0; b < volumes.size(); b++) {
+            volumes[b].tag = b + 1;
+            for (size_t e = 0; e < volumes[b].element_number; e++)
+                volumes[b].elements[e * 5] = element_tag++;
+        }
+
+        //surface entity per face group
+        std::vector<Msh_Entity> surfaces(face_groups.size());
+        for (int i = 0; i < face_groups.size(); i++) {
+            auto &s = surfaces[i];
+            s.dim = 2;
+            s.tag = i + 1;
+            s.name = face_groups[i].name;
+            s.element_number = face_groups[i].pointList.size() / 3;
+            bbox_init(s.bbox);
+            s.elements.reserve(s.element_number * 4);
+            for (size_t e = 0; e < s.element_number; e++) {
+                s.elements.push_back(element_tag++);
+                for (int k = 0; k < 3; k++) {
+                    int p = face_groups[i].pointList[e * 3 + k];
+                    s.elements.push_back(p + 1);
+                    bbox_add(s.bbox, &data.pointList[p * 3]);
+                }
+            }
+        }
+
+        FILE *fp = fopen(out_file_path, "wb");
+        if (fp == (FILE *) NULL) {
+            log_print("ERROR: can not create msh file: " + std::string(out_file_path));
+            return false;
+        }
+
+        fprintf(fp, "$MeshFormat\n4.1 1 %d\n", (int) sizeof(size_t));
+        write_binary(fp, (int) 1);
+        fprintf(fp, "\n$EndMeshFormat\n");
+
+        //physical tag == entity tag
+        fprintf(fp, "$PhysicalNames\n%d\n", (int) (volumes.size() + surfaces.size()));
+        for (const auto &s: surfaces)
+            fprintf(fp, "2 %d \"%s\"\n", s.tag, s.name.c_str());
+        for (const auto &v: volumes)
+            fprintf(fp, "3 %d \"%s\"\n", v.tag, v.name.c_str());
+        fprintf(fp, "$EndPhysicalNames\n");
+
+        fprintf(fp, "$Entities\n");
+        write_binary(fp, (size_t) 0);
+        write_binary(fp, (size_t) 0);
+        write_binary(fp, (size_t) surfaces.size());
+        write_binary(fp, (size_t) volumes.size());
+        for (const auto *entities: {&surfaces, &volumes}) {
+            for (const auto &e: *entities) {
+                write_binary(fp, e.tag);
+                fwrite(e.bbox.data(), sizeof(double), 6, fp);
+                write_binary(fp, (size_t) 1);
+                write_binary(fp, e.tag);
+                write_binary(fp, (size_t) 0); //no bounding entities
+            }
+        }
+        fprintf(fp, "\n$EndEntities\n");
+
+        //all nodes in one block, classified on the first volume (or surface)
+        fprintf(fp, "$Nodes\n");
+        size_t number_of_points = data.numberOfPoints;
+        write_binary(fp, (size_t) (number_of_points > 0 ? 1 : 0));
+        write_binary(fp, number_of_points);
+        write_binary(fp, (size_t) 1);
+        write_binary(fp, number_of_points);
+        if (number_of_points > 0) {
+            write_binary(fp, volumes.empty() ? 2 : 3);
+            write_binary(fp, 1);
+            write_binary(fp, 0);
+            write_binary(fp, number_of_points);
+            std::vector<size_t> node_tags(number_of_points);
+            for (size_t i = 0; i < number_of_points; i++)
+                node_tags[i] = i + 1;
+            write_binary(fp, node_tags);
+            fwrite(data.pointList, sizeof(double), number_of_points * 3, fp);
+        }
+        fprintf(fp, "\n$EndNodes\n");
+
+        fprintf(fp, "$Elements\n");
+        write_binary(fp, (size_t) (volumes.size() + surfaces.size()));
+        write_binary(fp, element_tag - 1);
+        write_binary(fp, (size_t) 1);
+        write_binary(fp, element_tag - 1);
+        for (const auto *entities: {&volumes, &surfaces}) {
+            for (const auto &e: *entities) {
+                write_binary(fp, e.dim);
+                write_binary(fp, e.tag);
+                write_binary(fp, e.dim == 3 ? msh_type_tetrahedron : msh_type_triangle);
+                write_binary(fp, e.element_number);
+                write_binary(fp, e.elements);
+            }
+        }
+        fprintf(fp, "\n$EndElements\n");
+
+        bool res = ferror(fp) == 0;
+        fclose(fp);
+        return res;
+    }
+
+}
@@ -5,6 +5,7 @@
 #include <map>
 #include <bitset>
 #include <array>
+#include <algorithm>
 
 #include <vtkCellData.h>
 #include <vtkCellTypes.h>
@@ -32,6 +33,10 @@
 #include <vtkDoubleArray.h>
 #include <vtkFloatArray.h>
 #include <vtkUnsignedIntArray.h>
+#include <vtkUnsignedCharArray.h>
+#include <vtkCellArray.h>
+#include <vtkArrayDispatch.h>
+#include <vtkDataArrayRange.h>
 
 #include "utils/file/file_path.h"
 #include "mesh_loader.h"
@@ -74,82 +79,239 @@ namespace Mesh_Loader {
         return result;
     }
 
+    namespace {
+        //typed bulk copy of all values (components interleaved), AOS arrays of the same type end up as a memmove
+        struct Copy_Values_Worker {
+            template<typename ArrayT, typename T>
+            void operator()(ArrayT *array, T *out) const {
+                const auto range = vtk::DataArrayValueRange(array);
+                std::transform(range.cbegin(), range.cend(), out, [](auto v) { return static_cast<T>(v); });
+            }
+        };
+
+        template<typename T>
+        void copy_values(vtkDataArray *array, T *out) {
+            Copy_Values_Worker worker;
+            if (!vtkArrayDispatch::Dispatch::Execute(array, worker, out))
+                worker(array, out);
+        }
+
+        template<typename T>
+        void copy_values(vtkDataArray *array, std::map<std::string, DataArray<T>> &arrays, const std::string &name) {
+            auto &content = arrays[name].content;
+            content.resize(array->GetNumberOfValues());
+            copy_values(array, content.data());
+        }
+
+        void copy_values(vtkDataArray *array, std::map<std::string, DataArray<bool>> &arrays, const std::string &name) {
+            std::vector<unsigned char> values(array->GetNumberOfValues());
+            copy_values(array, values.data());
+            arrays[name].content.assign(values.begin(), values.end());
+        }
+
+        void load_vtk_arrays(vtkFieldData *field_data, FileData &data, bool point) {
+            for (int i = 0; i < field_data->GetNumberOfArrays(); i++) {
+                vtkAbstractArray *array = field_data->GetAbstractArray(i);
+                std::string name = array->GetName() ? array->GetName() : "array_" + std::to_string(i);
+                if (array->GetNumberOfComponents() != 1) {
+                    log_print("WARN: skip vtu array with " + std::to_string(array->GetNumberOfComponents()) + " components: " + name);
+                    continue;
+                }
+                if (auto *string_array = vtkStringArray::SafeDownCast(array)) {
+                    auto &content = (point ? data.pointDataString : data.cellDataString)[name].content;
+                    content.resize(string_array->GetNumberOfValues());
+                    for (vtkIdType j = 0; j < string_array->GetNumberOfValues(); j++)
+                        content[j] = string_array->GetValue(j);
+                    continue;
+                }
+                vtkDataArray *data_array = vtkDataArray::SafeDownCast(array);
+                if (data_array == nullptr) {
+                    log_print("WARN: skip unsupport vtu array: " + name);
+                    continue;
+                }
+                switch (data_array->GetDataType()) {
+                    case VTK_DOUBLE:
+                        copy_values(data_array, point ? data.pointDataDouble : data.cellDataDouble, name);
+                        break;
+                    case VTK_FLOAT:
+                        copy_values(data_array, point ? data.pointDataFloat : data.cellDataFloat, name);
+                        break;
+                    case VTK_CHAR:
+                    case VTK_SIGNED_CHAR:
+                    case VTK_SHORT:
+                    case VTK_INT:
+                        copy_values(data_array, point ? data.pointDataInt : data.cellDataInt, name);
+                        break;
+                    case VTK_UNSIGNED_CHAR:
+                    case VTK_UNSIGNED_SHORT:
+                    case VTK_UNSIGNED_INT:
+                        copy_values(data_array, point ? data.pointDataUInt : data.cellDataUInt, name);
+                        break;
+                    //64 bit arrays are ids (bulk ids, original ids), there is no signed 64 bit slot in FileData
+                    case VTK_LONG:
+                    case VTK_UNSIGNED_LONG:
+                    case VTK_LONG_LONG:
+                    case VTK_UNSIGNED_LONG_LONG:
+                    case VTK_ID_TYPE:
+                        copy_values(data_array, point ? data.pointDataUInt64 : data.cellDataUInt64, name);
+                        break;
+                    case VTK_BIT:
+                        copy_values(data_array, point ? data.pointDataBool : data.cellDataBool, name);
+                        break;
+                    default:
+                        log_print("WARN: skip unsupport vtu array type: " + name);
+                }
+            }
+        }
+    }
+
     bool load_vtu(const char *in_file_path, FileData &data) {
-        //vtkDataSet *dataSet = ReadAnXMLFile<vtkXMLUnstructuredGridReader>(in_file_path);
         vtkSmartPointer<vtkXMLUnstructuredGridReader> reader = vtkSmartPointer<vtkXMLUnstructuredGridReader>::New();
         reader->SetFileName(in_file_path);
         reader->Update();
-        reader->GetOutput()->Register(reader);
         vtkUnstructuredGrid *g = reader->GetOutput();
+        if (g == nullptr || reader->GetErrorCode() != 0 || g->GetPoints() == nullptr) {
+            log_print("ERROR: can not read vtu file: " + std::string(in_file_path));
+            return false;
+        }
 
-        int numberofcell = g->GetNumberOfCells();
+        int numberofcell = g->GetCells() != nullptr ? g->GetNumberOfCells() : 0;
         int numberofpoint = g->GetNumberOfPoints();
 
-        vtkCellTypes *p_vtkCellTypes = vtkCellTypes::New();
-        g->GetCellTypes(p_vtkCellTypes);
-        int numberofcelltypes = p_vtkCellTypes->GetNumberOfTypes();
-        auto p_CellTypesArray = p_vtkCellTypes->GetCellTypesArray();
-
         //Point
         data.numberOfPoints = numberofpoint;
         data.pointList = new double[numberofpoint * 3];
-        for (int i = 0; i < numberofpoint; i++) {
-            g->GetPoint(i, &data.pointList[i]);
+        copy_values(g->GetPoints()->GetData(), data.pointList);
+
+        //Cell: one connectivity buffer, every cell points into it
+        std::vector<long long> offsets(numberofcell + 1, 0);
+        int *connectivity = nullptr;
+        vtkUnsignedCharArray *types = g->GetCellTypesArray();
+        if (numberofcell != 0) {
+            vtkCellArray *cells = g->GetCells();
+            copy_values(cells->GetOffsetsArray(), offsets.data());
+            connectivity = new int[cells->GetNumberOfConnectivityIds()];
+            copy_values(cells->GetConnectivityArray(), connectivity);
         }
 
-        //Cell
         data.numberOfCell = numberofcell;
         data.cellList = new Cell[numberofcell];
         for (int i = 0; i < numberofcell; i++) {
             auto &cell = data.cellList[i];
-            if (g->GetCellType(i) == 10) {
-                cell.numberOfPoints = 4;
-                cell.pointList = new int[4];
-                vtkIdType npts;
-                vtkIdType const *pts;
-                g->GetCellPoints(i, npts, pts);
-                assert(npts == 4);
-                cell.pointList[0] = pts[0];
-                cell.pointList[1] = pts[1];
-                cell.pointList[2] = pts[2];
-                cell.pointList[3] = pts[3];
-            }
-            else if (g->GetCellType(i) == 5) {
-                //triangle
-                //vtkCellTypes::GetClassNameFromTypeId
-                cell.numberOfPoints = 3;
-                cell.pointList = new int[3];
-                vtkIdType npts;
-                vtkIdType const *pts;
-                g->GetCellPoints(i, npts, pts);
-                assert(npts == 3);
-                cell.pointList[0] = pts[0];
-                cell.pointList[1] = pts[1];
-                cell.pointList[2] = pts[2];
+            int type = types->GetValue(i);
+            cell.numberOfPoints = offsets[i + 1] - offsets[i];
+            cell.pointList = connectivity + offsets[i];
+            if (!(type == VTK_TETRA && cell.numberOfPoints == 4) && !(type == VTK_TRIANGLE && cell.numberOfPoints == 3)) {
+                log_print("ERROR: unsupport vtu cell type, currently only support tetrahedra and triangle!");
+                return false;
             }
-            else {
-                ASSERT_MSG(false, "ERROR: unsupport vtu cell type, currently only support tetrahedra and triangle!");
+        }
+
+        //Cell Data and Point Data
+        load_vtk_arrays(g->GetCellData(), data, false);
+        load_vtk_arrays(g->GetPointData(), data, true);
+        return true;
+    }
+
+    bool load_file(const char *in_file_path, FileData &data) {
+        std::string extension = get_file_extension(in_file_path);
+        if (extension == "vtu")
+            return load_vtu(in_file_path, data);
+        if (extension == "f3zp")
+            return load_preview(in_file_path, data);
+        return load_f3grid(in_file_path, data);
+    }
+
+    bool get_cell_group_ids(const FileData &data, int slot, std::vector<int> &ids, std::vector<std::string> &names) {
+        ids.assign(data.numberOfCell, -1);
+        names.clear();
+
+        if (!data.cellDataInt.empty()) {
+            auto iter = data.cellDataInt.begin();
+            if (slot < data.cellDataInt.size())
+                std::advance(iter, slot);
+            const auto &content = iter->second.content;
+
+            //group number -> compact id
+            std::map<int, int> number_map;
+            for (int i = 0; i < data.numberOfCell; i++) {
+                if (content[i] >= 0)
+                    number_map[content[i]];
+            }
+            for (auto &item: number_map) {
+                item.second = names.size();
+                names.push_back(std::to_string(item.first));
             }
+            for (int i = 0; i < data.numberOfCell; i++) {
+                if (content[i] >= 0)
+                    ids[i] = number_map[content[i]];
+            }
+            return true;
         }
 
-        //Cell Data
-        vtkCellData *g_celldata = g->GetCellData();
-        int array_number = g_celldata->GetNumberOfArrays();
-        //data.cellDataString.resize(array_number);
-        for (int i = 0; i < array_number; i++) {
-            vtkAbstractArray *array = g_celldata->GetAbstractArray(i);
-            //g_celldata->GetAbstractArray(0)->GetDataType () -> 13
-            //g_celldata->GetAbstractArray(0)->GetNumberOfValues() ->1558755
-            ASSERT_MSG(array->GetDataType() == 13, "RROR: unsupport vtu celldata type, currently only support string!")
-            data.cellDataString[array->GetName()];
-            std::vector<std::string> &string_array = data.cellDataString[array->GetName()].content;
-            string_array.resize(array->GetNumberOfValues());
-            for (int j = 0; j < array->GetNumberOfValues(); j++) {
-                vtkStdString *vtkstring = (vtkStdString *) array->GetVoidPointer(j);
-                string_array[i] = *vtkstring;
+        if (!data.cellDataString.empty()) {
+            auto iter = data.cellDataString.begin();
+            if (slot < data.cellDataString.size())
+                std::advance(iter, slot);
+            const auto &content = iter->second.content;
+
+            std::map<std::string, int> name_map;
+            for (int i = 0; i < data.numberOfCell; i++) {
+                if (!content[i].empty())
+                    name_map[content[i]];
+            }
+            for (auto &item: name_map) {
+                item.second = names.size();
+                names.push_back(item.first);
             }
+            for (int i = 0; i < data.numberOfCell; i++) {
+                if (!content[i].empty())
+                    ids[i] = name_map[content[i]];
+            }
+            return true;
         }
-        return true;
+        return false;
+    }
+
+    std::vector<FaceGroup> get_face_groups(const FileData &data) {
+        std::vector<FaceGroup> res;
+        auto is_f_slot = [](const std::string &name) {
+            return name.size() > 2 && name.compare(name.size() - 2, 2, "_F") == 0;
+        };
+        auto add_face = [&](std::map<std::string, int> &group_index, const std::string &group_name, int cell_index) {
+            const Cell &cell = data.cellList[cell_index];
+            if (cell.numberOfPoints != 3)
+                return;
+            auto iter = group_index.find(group_name);
+            if (iter == group_index.end()) {
+                iter = group_index.insert({group_name, (int) res.size()}).first;
+                res.push_back({group_name, {}});
+            }
+            auto &point_list = res[iter->second].pointList;
+            point_list.insert(point_list.end(), cell.pointList, cell.pointList + 3);
+        };
+
+        for (auto iter = data.cellDataInt.begin(); iter != data.cellDataInt.end(); iter++) {
+            if (!is_f_slot(iter->first))
+                continue;
+            std::map<std::string, int> group_index;
+            std::string slot_name = iter->first.substr(0, iter->first.size() - 2);
+            for (int i = 0; i < data.numberOfCell; i++) {
+                if (iter->second.content[i] >= 0)
+                    add_face(group_index, slot_name + ":" + std::to_string(iter->second.content[i]), i);
+            }
+        }
+        for (auto iter = data.cellDataString.begin(); iter != data.cellDataString.end(); iter++) {
+            if (!is_f_slot(iter->first))
+                continue;
+            std::map<std::string, int> group_index;
+            std::string slot_name = iter->first.substr(0, iter->first.size() - 2);
+            for (int i = 0; i < data.numberOfCell; i++) {
+                if (!iter->second.content[i].empty())
+                    add_face(group_index, slot_name + ":" + iter->second.content[i], i);
+            }
+        }
+        return res;
     }
 
     bool load_f3grid(const char *in_file_path, FileData &data) {
@@ -414,6 +576,9 @@ namespace Mesh_Loader {
 
 
     bool save_vtu(const char *out_file_path, const FileData &data) {
+        if (config.fast_ascii)
+            return save_vtu_ascii(out_file_path, data);
+
         vtkNew<vtkPoints> points;
         vtkNew<vtkTetra> tetra;
         vtkNew<vtkTriangle> triangle;
@@ -423,6 +588,8 @@ namespace Mesh_Loader {
         celltypes->SetNumberOfComponents(1);
         celltypes->SetNumberOfValues(data.numberOfCell);
 
+        //Float64 like the ascii and appended writers, vtkPoints would round to float
+        points->SetDataTypeToDouble();
         for (int i = 0; i < data.numberOfPoints; i++) {
             points->InsertNextPoint(data.pointList[i * 3], data.pointList[i * 3 + 1], data.pointList[i * 3 + 2]);
         }
@@ -5,6 +5,7 @@
 #include <cassert>
 #include <string>
 #include <vector>
+#include <map>
 #include "utils/file/file_path.h"
 
 namespace Mesh_Loader {
@@ -16,6 +17,7 @@ namespace Mesh_Loader {
         VTU,
         MESH,
         F3GRID,
+        F3ZP,
         UNKNOW
     };
 
@@ -62,12 +64,62 @@ namespace Mesh_Loader {
     };
 
 
+    struct FaceGroup {
+        std::string name;
+        std::vector<int> pointList; //3 point index per face
+    };
+
+    //group id of each cell from the cell data array selected by slot (same indexing as export_materialids_using_slot),
+    //-1 means the cell is not in any group, names[id] is the group name
+    bool get_cell_group_ids(const FileData &data, int slot, std::vector<int> &ids, std::vector<std::string> &names);
+
+    //triangle groups from the FGROUP ("*_F") cell data arrays
+    std::vector<FaceGroup> get_face_groups(const FileData &data);
+
     bool load_f3grid(const char *in_file_path, FileData &data);
 
     bool load_vtu(const char *in_file_path, FileData &data);
 
+    //dispatch on the file extension: .vtu, .f3zp, anything else is read as f3grid
+    bool load_file(const char *in_file_path, FileData &data);
+
     bool save_vtu(const char *out_file_path, const FileData &data);
 
+    //ascii vtu formatted in parallel with std::to_chars, used by save_vtu when config.fast_ascii is on
+    bool save_vtu_ascii(const char *out_file_path, const FileData &data);
+
+    //binary vtu, raw appended: geometry blocks first, attribute blocks last, padded xml header with a geometry hash
+    bool save_vtu_appended(const char *out_file_path, const FileData &data);
+
+    //rewrite only the header and attribute blocks of a save_vtu_appended file,
+    //false (file untouched) if the file has another layout, the geometry hash differs or the header does not fit
+    bool update_vtu_attributes(const char *out_file_path, const FileData &data);
+
+    //ZGROUP slot -> element blocks, face groups -> side sets
+    bool save_exodus(const char *out_file_path, const FileData &data, int material_slot, const std::vector<FaceGroup> &face_groups);
+
+    //binary MSH 4.1, ZGROUP slot -> physical volumes, face groups -> physical surfaces
+    bool save_msh(const char *out_file_path, const FileData &data, int material_slot, const std::vector<FaceGroup> &face_groups);
+
+    //compression_level: 0 disable, 1-9 gzip level, string arrays -> int index + FieldData/<name>_names table
+    bool save_vtkhdf(const char *out_file_path, const FileData &data, int compression_level = 0);
+
+    //f3grid -> vtu (raw appended) with peak memory proportional to batch_size (items per buffer), the mesh is
+    //spilled to temp files next to the output; same cells and group arrays as load_f3grid + save_vtu with the same
+    //array_to_number (Int32 group ids instead of names) and export_face_related (triangles and FGROUP kept) settings
+    bool convert_f3grid_to_vtu_streaming(const char *in_file_path, const char *out_file_path, size_t batch_size,
+                                         bool array_to_number, bool face_related);
+
+    //int/string cell arrays "<slot>_Z" -> ZGROUP, "<slot>_F" -> FGROUP, int/string point arrays "<slot>_G" -> GGROUP,
+    //arrays with other names are skipped
+    bool save_f3grid(const char *out_file_path, const FileData &data);
+
+    //lossy preview (.f3zp): coordinates and float/double arrays compressed by zfp with absolute error
+    //<= coord_tolerance / field_tolerance (<= 0 means lossless), topology and other arrays deflated
+    bool save_preview(const char *out_file_path, const FileData &data, double coord_tolerance, double field_tolerance);
+
+    bool load_preview(const char *in_file_path, FileData &data);
+
 
 }
 
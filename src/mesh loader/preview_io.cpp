@@ -0,0 +1,465 @@
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <algorithm>
+#include <type_traits>
+
+#include "vtk_zlib.h"
+#include "vtkzfp/include/zfp.h"
+
+#include "mesh_loader.h"
+#include "utils/log/log.h"
+
+// .f3zp preview container:
+//   header: "F3ZP", version, point/cell number, tolerances, measured max coordinate error
+//   x, y, z        zfp fixed-accuracy (absolute error <= coord tolerance)
+//   cell sizes     deflate, uint8 (3 or 4)
+//   connectivity   deflate, zigzag varint (first id delta to the previous cell, others delta to the first id)
+//   data arrays    float/double: zfp with the field tolerance, everything else deflate (lossless)
+// every block is {uint8 codec, uint64 raw bytes, uint64 stored bytes, bytes}
+namespace Mesh_Loader {
+
+    namespace {
+        const char preview_magic[4] = {'F', '3', 'Z', 'P'};
+        const uint32_t preview_version = 1;
+
+        enum Preview_Codec : uint8_t {
+            codec_deflate = 0,
+            codec_zfp = 1
+        };
+
+        enum Preview_Type : uint8_t {
+            type_string = 0,
+            type_double,
+            type_float,
+            type_int,
+            type_uint,
+            type_uint64,
+            type_bool
+        };
+
+        enum Preview_Location : uint8_t {
+            location_point = 0,
+            location_cell
+        };
+
+        struct Preview_Block {
+            uint8_t codec = codec_deflate;
+            uint64_t raw_bytes = 0;
+            std::vector<unsigned char> bytes;
+        };
+
+        template<typename T>
+        void write_binary(FILE *fp, const T &value) {
+            fwrite(&value, sizeof(T), 1, fp);
+        }
+
+        template<typename T>
+        bool read_binary(FILE *fp, T &value) {
+            return fread(&value, sizeof(T), 1, fp) == 1;
+        }
+
+        void write_block(FILE *fp, const Preview_Block &block) {
+            write_binary(fp, block.codec);
+            write_binary(fp, block.raw_bytes);
+            write_binary(fp, (uint64_t) block.bytes.size());
+            if (!block.bytes.empty())
+                fwrite(block.bytes.data(), 1, block.bytes.size(), fp);
+        }
+
+        bool read_block(FILE *fp, Preview_Block &block) {
+            uint64_t stored_bytes;
+            if (!read_binary(fp, block.codec) || !read_binary(fp, block.raw_bytes) || !read_binary(fp, stored_bytes))
+                return false;
+            block.bytes.resize(stored_bytes);
+            return stored_bytes == 0 || fread(block.bytes.data(), 1, stored_bytes, fp) == stored_bytes;
+        }
+
+        Preview_Block deflate_block(const void *values, size_t raw_bytes) {
+            Preview_Block block;
+            block.codec = codec_deflate;
+            block.raw_bytes = raw_bytes;
+            if (raw_bytes == 0)
+                return block;
+            uLongf size = compressBound(raw_bytes);
+            block.bytes.resize(size);
+            compress2(block.bytes.data(), &size, (const Bytef *) values, raw_bytes, Z_BEST_COMPRESSION);
+            block.bytes.resize(size);
+            return block;
+        }
+
+        bool inflate_block(const Preview_Block &block, void *values, size_t raw_bytes) {
+            if (block.codec != codec_deflate || block.raw_bytes != raw_bytes)
+                return false;
+            if (raw_bytes == 0)
+                return true;
+            uLongf size = raw_bytes;
+            return uncompress((Bytef *) values, &size, block.bytes.data(), block.bytes.size()) == Z_OK && size == raw_bytes;
+        }
+
+        template<typename T>
+        zfp_type zfp_type_of() {
+            return std::is_same_v<T, double> ? zfp_type_double : zfp_type_float;
+        }
+
+        //tolerance <= 0 selects zfp's reversible (lossless) mode
+        template<typename T>
+        Preview_Block zfp_block(const T *values, size_t n, double tolerance) {
+            Preview_Block block;
+            block.codec = codec_zfp;
+            block.raw_bytes = n * sizeof(T);
+            if (n == 0)
+                return block;
+            zfp_field *field = zfp_field_1d((void *) values, zfp_type_of<T>(), n);
+            zfp_stream *zfp = zfp_stream_open(nullptr);
+            if (tolerance > 0)
+                zfp_stream_set_accuracy(zfp, tolerance);
+            else
+                zfp_stream_set_reversible(zfp);
+            block.bytes.resize(zfp_stream_maximum_size(zfp, field));
+            bitstream *stream = stream_open(block.bytes.data(), block.bytes.size());
+            zfp_stream_set_bit_stream(zfp, stream);
+            zfp_stream_rewind(zfp);
+            block.bytes.resize(zfp_compress(zfp, field));
+            zfp_field_free(field);
+            zfp_stream_close(zfp);
+            stream_close(stream);
+            return block;
+        }
+
+        //the stream header is not stored, the mode is restored from the file header tolerance
+        template<typename T>
+        bool unzfp_block(const Preview_Block &block, T *values, size_t n, double tolerance) {
+            if (block.codec != codec_zfp || block.raw_bytes != n * sizeof(T))
+                return false;
+            if (n == 0)
+                return true;
+            zfp_field *field = zfp_field_1d(values, zfp_type_of<T>(), n);
+            zfp_stream *zfp = zfp_stream_open(nullptr);
+            if (tolerance > 0)
+                zfp_stream_set_accuracy(zfp, tolerance);
+            else
+                zfp_stream_set_reversible(zfp);
+            bitstream *stream = stream_open((void *) block.bytes.data(), block.bytes.size());
+            zfp_stream_set_bit_stream(zfp, stream);
+            zfp_stream_rewind(zfp);
+            bool res = zfp_decompress(zfp, field) != 0;
+            zfp_field_free(field);
+            zfp_stream_close(zfp);
+            stream_close(stream);
+            return res;
+        }
+
+        inline void put_varint(std::vector<unsigned char> &out, uint64_t v) {
+            while (v >= 0x80) {
+                out.push_back((unsigned char) (v | 0x80));
+                v >>= 7;
+            }
+            out.push_back((unsigned char) v);
+        }
+
+        inline bool get_varint(const unsigned char *&p, const unsigned char *end, uint64_t &v) {
+            v = 0;
+            for (int shift = 0; p < end && shift < 64; shift += 7) {
+                unsigned char c = *p++;
+                v |= (uint64_t) (c & 0x7f) << shift;
+                if ((c & 0x80) == 0)
+                    return true;
+            }
+            return false;
+        }
+
+        inline uint64_t zigzag(int64_t v) { return ((uint64_t) v << 1) ^ (uint64_t) (v >> 63); }
+
+        inline int64_t unzigzag(uint64_t v) { return (int64_t) (v >> 1) ^ -(int64_t) (v & 1); }
+
+        struct Preview_Writer {
+            FILE *fp;
+            double field_tolerance;
+            uint32_t array_number = 0;
+
+            void array_header(Preview_Location location, Preview_Type type, const std::string &name) {
+                write_binary(fp, (uint8_t) location);
+                write_binary(fp, (uint8_t) type);
+                write_binary(fp, (uint32_t) name.size());
+                fwrite(name.data(), 1, name.size(), fp);
+                array_number++;
+            }
+
+            template<typename T>
+            void write_arrays(Preview_Location location, const std::map<std::string, DataArray<T>> &arrays) {
+                for (auto iter = arrays.begin(); iter != arrays.end(); iter++) {
+                    const auto &content = iter->second.content;
+                    if constexpr (std::is_same_v<T, std::string>) {
+                        //dictionary of the distinct strings + int index
+                        array_header(location, type_string, iter->first);
+                        std::map<std::string, int> dictionary;
+                        for (const auto &s: content)
+                            dictionary[s];
+                        std::string joined;
+                        int id = 0;
+                        for (auto &item: dictionary) {
+                            item.second = id++;
+                            joined += item.first;
+                            joined += '\0';
+                        }
+                        std::vector<int> index(content.size());
+                        for (size_t i = 0; i < content.size(); i++)
+                            index[i] = dictionary[content[i]];
+                        write_block(fp, deflate_block(joined.data(), joined.size()));
+                        write_block(fp, deflate_block(index.data(), index.size() * sizeof(int)));
+                    }
+                    else if constexpr (std::is_same_v<T, bool>) {
+                        array_header(location, type_bool, iter->first);
+                        std::vector<uint8_t> values(content.begin(), content.end());
+                        write_block(fp, deflate_block(values.data(), values.size()));
+                    }
+                    else if constexpr (std::is_floating_point_v<T>) {
+                        array_header(location, std::is_same_v<T, double> ? type_double : type_float, iter->first);
+                        write_block(fp, zfp_block(content.data(), content.size(), field_tolerance));
+                    }
+                    else {
+                        Preview_Type type = std::is_same_v<T, int> ? type_int : std::is_same_v<T, unsigned int> ? type_uint : type_uint64;
+                        array_header(location, type, iter->first);
+                        write_block(fp, deflate_block(content.data(), content.size() * sizeof(T)));
+                    }
+                }
+            }
+        };
+
+        template<typename T>
+        bool read_array(FILE *fp, std::vector<T> &content, size_t n, double field_tolerance) {
+            Preview_Block block;
+            if (!read_block(fp, block))
+                return false;
+            content.resize(n);
+            if constexpr (std::is_floating_point_v<T>)
+                return unzfp_block(block, content.data(), n, field_tolerance);
+            else
+                return inflate_block(block, content.data(), n * sizeof(T));
+        }
+    }
+
+    bool save_preview(const char *out_file_path, const FileData &data, double coord_tolerance, double field_tolerance) {
+        size_t npoints = data.numberOfPoints;
+        size_t ncells = data.numberOfCell;
+
+        std::vector<double> axis[3];
+        Preview_Block coord_blocks[3];
+        double max_coord_error = 0;
+        for (int k = 0; k < 3; k++) {
+            axis[k].resize(npoints);
+            for (size_t i = 0; i < npoints; i++)
+                axis[k][i] = data.pointList[i * 3 + k];
+            coord_blocks[k] = zfp_block(axis[k].data(), npoints, coord_tolerance);
+
+            //measure the error actually committed, it is stored in the header
+            std::vector<double> decoded(npoints);
+            if (!unzfp_block(coord_blocks[k], decoded.data(), npoints, coord_tolerance)) {
+                log_print("ERROR: zfp compress coordinates fail");
+                return false;
+            }
+            for (size_t i = 0; i < npoints; i++)
+                max_coord_error = std::max(max_coord_error, std::abs(decoded[i] - axis[k][i]));
+        }
+
+        std::vector<uint8_t> cell_sizes(ncells);
+        std::vector<unsigned char> connectivity;
+        connectivity.reserve(ncells * 6);
+        int64_t previous_first = 0;
+        for (size_t i = 0; i < ncells; i++) {
+            const Cell &cell = data.cellList[i];
+            if (cell.numberOfPoints != 4 && cell.numberOfPoints != 3) {
+                log_print("ERROR: unsupport input");
+                return false;
+            }
+            cell_sizes[i] = cell.numberOfPoints;
+            int64_t first = cell.pointList[0];
+            put_varint(connectivity, zigzag(first - previous_first));
+            for (int k = 1; k < cell.numberOfPoints; k++)
+                put_varint(connectivity, zigzag(cell.pointList[k] - first));
+            previous_first = first;
+        }
+
+        FILE *fp = fopen(out_file_path, "wb");
+        if (fp == (FILE *) NULL) {
+            log_print("ERROR: can not create preview file: " + std::string(out_file_path));
+            return false;
+        }
+
+        fwrite(preview_magic, 1, 4, fp);
+        write_binary(fp, preview_version);
+        write_binary(fp, (uint64_t) npoints);
+        write_binary(fp, (uint64_t) ncells);
+        write_binary(fp, coord_tolerance);
+        write_binary(fp, field_tolerance);
+        write_binary(fp, max_coord_error);
+        for (int k = 0; k < 3; k++)
+            write_block(fp, coord_blocks[k]);
+        write_block(fp, deflate_block(cell_sizes.data(), cell_sizes.size()));
+        write_block(fp, deflate_block(connectivity.data(), connectivity.size()));
+
+        //array count is patched once all arrays are written
+        long array_number_pos = ftell(fp);
+        write_binary(fp, (uint32_t) 0);
+        Preview_Writer writer{fp, field_tolerance};
+        writer.write_arrays(location_point, data.pointDataString);
+        writer.write_arrays(location_point, data.pointDataDouble);
+        writer.write_arrays(location_point, data.pointDataFloat);
+        writer.write_arrays(location_point, data.pointDataInt);
+        writer.write_arrays(location_point, data.pointDataUInt);
+        writer.write_arrays(location_point, data.pointDataUInt64);
+        writer.write_arrays(location_point, data.pointDataBool);
+        writer.write_arrays(location_cell, data.cellDataString);
+        writer.write_arrays(location_cell, data.cellDataDouble);
+        writer.write_arrays(location_cell, data.cellDataFloat);
+        writer.write_arrays(location_cell, data.cellDataInt);
+        writer.write_arrays(location_cell, data.cellDataUInt);
+        writer.write_arrays(location_cell, data.cellDataUInt64);
+        writer.write_arrays(location_cell, data.cellDataBool);
+        fseek(fp, array_number_pos, SEEK_SET);
+        write_binary(fp, writer.array_number);
+
+        bool res = ferror(fp) == 0;
+        fclose(fp);
+        if (res)
+            log_print("preview max coordinate error: " + std::to_string(max_coord_error));
+        return res;
+    }
+
+    bool load_preview(const char *in_file_path, FileData &data) {
+        FILE *fp = fopen(in_file_path, "rb");
+        if (fp == (FILE *) NULL) {
+            log_print("ERROR: can not open preview file: " + std::string(in_file_path));
+            return false;
+        }
+
+        char magic[4];
+        uint32_t version;
+        uint64_t npoints, ncells;
+        double coord_tolerance, field_tolerance, max_coord_error;
+        bool res = fread(magic, 1, 4, fp) == 4 && memcmp(magic, preview_magic, 4) == 0 &&
+                   read_binary(fp, version) && version == preview_version &&
+                   read_binary(fp, npoints) && read_binary(fp, ncells) &&
+                   read_binary(fp, coord_tolerance) && read_binary(fp, field_tolerance) && read_binary(fp, max_coord_error);
+        if (!res) {
+            log_print("ERROR: not a preview file: " + std::string(in_file_path));
+            fclose(fp);
+            return false;
+        }
+
+        data.numberOfPoints = npoints;
+        data.pointList = new double[npoints * 3];
+        std::vector<double> axis(npoints);
+        for (int k = 0; res && k < 3; k++) {
+            Preview_Block block;
+            res = read_block(fp, block) && unzfp_block(block, axis.data(), npoints, coord_tolerance);
+            for (size_t i = 0; res && i < npoints; i++)
+                data.pointList[i * 3 + k] = axis[i];
+        }
+
+        std::vector<uint8_t> cell_sizes;
+        std::vector<unsigned char> connectivity;
+        if (res) {
+            Preview_Block size_block, connectivity_block;
+            res = read_block(fp, size_block) && read_block(fp, connectivity_block);
+            cell_sizes.resize(ncells);
+            connectivity.resize(connectivity_block.raw_bytes);
+            res = res && inflate_block(size_block, cell_sizes.data(), ncells) &&
+                  inflate_block(connectivity_block, connectivity.data(), connectivity.size());
+        }
+        if (res) {
+            data.numberOfCell = ncells;
+            data.cellList = new Cell[ncells];
+            const unsigned char *p = connectivity.data();
+            const unsigned char *end = p + connectivity.size();
+            int64_t first = 0;
+            for (size_t i = 0; res && i < ncells; i++) {
+                Cell &cell = data.cellList[i];
+                cell.numberOfPoints = cell_sizes[i];
+                cell.pointList = new int[cell.numberOfPoints];
+                uint64_t v;
+                res = get_varint(p, end, v);
+                first += unzigzag(v);
+                cell.pointList[0] = first;
+                for (int k = 1; res && k < cell.numberOfPoints; k++) {
+                    res = get_varint(p, end, v);
+                    cell.pointList[k] = first + unzigzag(v);
+                }
+            }
+        }
+
+        uint32_t array_number = 0;
+        res = res && read_binary(fp, array_number);
+        for (uint32_t a = 0; res && a < array_number; a++) {
+            uint8_t location, type;
+            uint32_t name_length;
+            res = read_binary(fp, location) && read_binary(fp, type) && read_binary(fp, name_length);
+            if (!res)
+                break;
+            std::string name(name_length, '\0');
+            res = name_length == 0 || fread(name.data(), 1, name_length, fp) == name_length;
+            bool point = location == location_point;
+            size_t n = point ? npoints : ncells;
+            switch (type) {
+                case type_string: {
+                    Preview_Block dictionary_block;
+                    std::vector<int> index;
+                    res = res && read_block(fp, dictionary_block) && read_array(fp, index, n, field_tolerance);
+                    std::string joined(dictionary_block.raw_bytes, '\0');
+                    res = res && inflate_block(dictionary_block, joined.data(), joined.size());
+                    std::vector<std::string> dictionary;
+                    for (size_t b = 0, e; res && b < joined.size(); b = e + 1) {
+                        e = joined.find('\0', b);
+                        dictionary.push_back(joined.substr(b, e - b));
+                    }
+                    auto &content = (point ? data.pointDataString : data.cellDataString)[name].content;
+                    content.resize(n);
+                    for (size_t i = 0; res && i < n; i++) {
+                        res = index[i] >= 0 && index[i] < dictionary.size();
+                        if (res)
+                            content[i] = dictionary[index[i]];
+                    }
+                    break;
+                }
+                case type_double:
+                    res = res && read_array(fp, (point ? data.pointDataDouble : data.cellDataDouble)[name].content, n, field_tolerance);
+                    break;
+                case type_float:
+                    res = res && read_array(fp, (point ? data.pointDataFloat : data.cellDataFloat)[name].content, n, field_tolerance);
+                    break;
+                case type_int:
+                    res = res && read_array(fp, (point ? data.pointDataInt : data.cellDataInt)[name].content, n, field_tolerance);
+                    break;
+                case type_uint:
+                    res = res && read_array(fp, (point ? data.pointDataUInt : data.cellDataUInt)[name].content, n, field_tolerance);
+                    break;
+                case type_uint64:
+                    res = res && read_array(fp, (point ? data.pointDataUInt64 : data.cellDataUInt64)[name].content, n, field_tolerance);
+                    break;
+                case type_bool: {
+                    std::vector<uint8_t> values;
+                    res = res && read_array(fp, values, n, field_tolerance);
+                    auto &content = (point ? data.pointDataBool : data.cellDataBool)[name].content;
+                    content.assign(values.begin(), values.end());
+                    break;
+                }
+                default:
+                    res = false;
+            }
+        }
+
+        fclose(fp);
+        if (!res)
+            log_print("ERROR: broken preview file: " + std::string(in_file_path));
+        else
+            log_print("preview max coordinate error: " + std::to_string(max_coord_error));
+        return res;
+    }
+
+}
@@ -0,0 +1,296 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+#include "vtk_hdf5.h"
+#include <vtkCellType.h>
+
+#include "mesh_loader.h"
+#include "utils/log/log.h"
+
+// VTKHDF UnstructuredGrid layout (single piece, no time steps):
+//   /VTKHDF                 attrs Version = {1, 0}, Type = "UnstructuredGrid"
+//   /VTKHDF/NumberOfPoints, NumberOfCells, NumberOfConnectivityIds   (1)
+//   /VTKHDF/Points          (numberOfPoints, 3)
+//   /VTKHDF/Connectivity, Offsets (numberOfCell + 1), Types
+//   /VTKHDF/CellData/<name>, /VTKHDF/PointData/<name>
+//   /VTKHDF/FieldData/<name>_names   name table of a string array, <name> holds the int index into it
+namespace Mesh_Loader {
+
+    namespace {
+        const hsize_t vtkhdf_chunk_rows = 1 << 16;
+
+        template<typename T>
+        hid_t h5_native_type();
+
+        template<>
+        hid_t h5_native_type<double>() { return H5T_NATIVE_DOUBLE; }
+
+        template<>
+        hid_t h5_native_type<float>() { return H5T_NATIVE_FLOAT; }
+
+        template<>
+        hid_t h5_native_type<int>() { return H5T_NATIVE_INT; }
+
+        template<>
+        hid_t h5_native_type<unsigned int>() { return H5T_NATIVE_UINT; }
+
+        template<>
+        hid_t h5_native_type<unsigned long long>() { return H5T_NATIVE_ULLONG; }
+
+        template<>
+        hid_t h5_native_type<long long>() { return H5T_NATIVE_LLONG; }
+
+        template<>
+        hid_t h5_native_type<unsigned char>() { return H5T_NATIVE_UCHAR; }
+
+        // Chunked (and deflated when compression_level > 0) dataset of shape (rows) or (rows, cols).
+        template<typename T>
+        bool write_dataset(hid_t group, const char *name, const T *values, hsize_t rows, hsize_t cols, int compression_level) {
+            hsize_t dims[2] = {rows, cols};
+            int rank = cols > 1 ? 2 : 1;
+
+            hid_t space = H5Screate_simple(rank, dims, nullptr);
+            hid_t plist = H5Pcreate(H5P_DATASET_CREATE);
+            if (rows > 0) {
+                hsize_t chunk[2] = {std::min(rows, vtkhdf_chunk_rows), cols};
+                H5Pset_chunk(plist, rank, chunk);
+                if (compression_level > 0) {
+                    H5Pset_shuffle(plist);
+                    H5Pset_deflate(plist, std::min(compression_level, 9));
+                }
+            }
+
+            hid_t dset = H5Dcreate2(group, name, h5_native_type<T>(), space, H5P_DEFAULT, plist, H5P_DEFAULT);
+            herr_t status = -1;
+            if (dset >= 0) {
+                status = rows > 0 ? H5Dwrite(dset, h5_native_type<T>(), H5S_ALL, H5S_ALL, H5P_DEFAULT, values) : 0;
+                H5Dclose(dset);
+            }
+            H5Pclose(plist);
+            H5Sclose(space);
+
+            if (status < 0) {
+                log_print("ERROR: write vtkhdf dataset fail: " + std::string(name));
+                return false;
+            }
+            return true;
+        }
+
+        bool write_scalar(hid_t group, const char *name, long long value) {
+            return write_dataset<long long>(group, name, &value, 1, 1, 0);
+        }
+
+        template<typename T>
+        bool write_array_map(hid_t group, const std::map<std::string, DataArray<T>> &arrays, int compression_level) {
+            for (auto iter = arrays.begin(); iter != arrays.end(); iter++) {
+                const auto &content = iter->second.content;
+                if (!write_dataset<T>(group, iter->first.c_str(), content.data(), content.size(), 1, compression_level))
+                    return false;
+            }
+            return true;
+        }
+
+        bool write_array_map(hid_t group, const std::map<std::string, DataArray<bool>> &arrays, int compression_level) {
+            //same as save_vtu, bool is exported as int
+            for (auto iter = arrays.begin(); iter != arrays.end(); iter++) {
+                std::vector<int> content(iter->second.content.begin(), iter->second.content.end());
+                if (!write_dataset<int>(group, iter->first.c_str(), content.data(), content.size(), 1, compression_level))
+                    return false;
+            }
+            return true;
+        }
+
+        // Fixed-length string dataset of shape (values.size()).
+        bool write_string_dataset(hid_t group, const char *name, const std::vector<std::string> &values) {
+            size_t width = 1;
+            for (auto &value: values)
+                width = std::max(width, value.size());
+            std::vector<char> buffer(values.size() * width, '\0');
+            for (size_t i = 0; i < values.size(); i++)
+                std::copy(values[i].begin(), values[i].end(), buffer.begin() + i * width);
+
+            hid_t type = H5Tcopy(H5T_C_S1);
+            H5Tset_size(type, width);
+            H5Tset_strpad(type, H5T_STR_NULLPAD);
+            H5Tset_cset(type, H5T_CSET_ASCII);
+            hsize_t dims[1] = {values.size()};
+            hid_t space = H5Screate_simple(1, dims, nullptr);
+            hid_t dset = H5Dcreate2(group, name, type, space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+            herr_t status = -1;
+            if (dset >= 0) {
+                status = values.empty() ? 0 : H5Dwrite(dset, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, buffer.data());
+                H5Dclose(dset);
+            }
+            H5Sclose(space);
+            H5Tclose(type);
+
+            if (status < 0) {
+                log_print("ERROR: write vtkhdf dataset fail: " + std::string(name));
+                return false;
+            }
+            return true;
+        }
+
+        //vtkhdf has no string attribute arrays: <name> is written as the int index of each value in the
+        //sorted name table, the table itself goes to /VTKHDF/FieldData/<name>_names
+        bool write_string_array_map(hid_t group, hid_t field_group, const std::map<std::string, DataArray<std::string>> &arrays,
+                                    int compression_level) {
+            for (auto iter = arrays.begin(); iter != arrays.end(); iter++) {
+                const auto &content = iter->second.content;
+                std::vector<std::string> names(content.begin(), content.end());
+                std::sort(names.begin(), names.end());
+                names.erase(std::unique(names.begin(), names.end()), names.end());
+
+                std::vector<int> index(content.size());
+                for (size_t i = 0; i < content.size(); i++)
+                    index[i] = int(std::lower_bound(names.begin(), names.end(), content[i]) - names.begin());
+
+                if (!write_dataset<int>(group, iter->first.c_str(), index.data(), index.size(), 1, compression_level))
+                    return false;
+                if (!write_string_dataset(field_group, (iter->first + "_names").c_str(), names))
+                    return false;
+            }
+            return true;
+        }
+
+        bool write_string_attribute(hid_t obj, const char *name, const std::string &value) {
+            hid_t type = H5Tcopy(H5T_C_S1);
+            H5Tset_size(type, value.size());
+            H5Tset_strpad(type, H5T_STR_NULLPAD);
+            H5Tset_cset(type, H5T_CSET_ASCII);
+            hid_t space = H5Screate(H5S_SCALAR);
+            hid_t attr = H5Acreate2(obj, name, type, space, H5P_DEFAULT, H5P_DEFAULT);
+            herr_t status = attr >= 0 ? H5Awrite(attr, type, value.c_str()) : -1;
+            if (attr >= 0)
+                H5Aclose(attr);
+            H5Sclose(space);
+            H5Tclose(type);
+            return status >= 0;
+        }
+
+        bool write_version_attribute(hid_t obj) {
+            int version[2] = {1, 0};
+            hsize_t dims[1] = {2};
+            hid_t space = H5Screate_simple(1, dims, nullptr);
+            hid_t attr = H5Acreate2(obj, "Version", H5T_NATIVE_INT, space, H5P_DEFAULT, H5P_DEFAULT);
+            herr_t status = attr >= 0 ? H5Awrite(attr, H5T_NATIVE_INT, version) : -1;
+            if (attr >= 0)
+                H5Aclose(attr);
+            H5Sclose(space);
+            return status >= 0;
+        }
+    }
+
+    bool save_vtkhdf(const char *out_file_path, const FileData &data, int compression_level) {
+        //flatten cells
+        std::vector<long long> offsets(data.numberOfCell + 1);
+        std::vector<unsigned char> types(data.numberOfCell);
+        offsets[0] = 0;
+        for (int i = 0; i < data.numberOfCell; i++) {
+            const Cell &cell = data.cellList[i];
+            if (cell.numberOfPoints == 4) {
+                types[i] = VTK_TETRA;
+            }
+            else if (cell.numberOfPoints == 3) {
+                types[i] = VTK_TRIANGLE;
+            }
+            else {
+                log_print("ERROR: unsupport input");
+                return false;
+            }
+            offsets[i + 1] = offsets[i] + cell.numberOfPoints;
+        }
+        std::vector<long long> connectivity(offsets.back());
+        for (int i = 0; i < data.numberOfCell; i++) {
+            const Cell &cell = data.cellList[i];
+            std::copy(cell.pointList, cell.pointList + cell.numberOfPoints, connectivity.begin() + offsets[i]);
+        }
+
+        hid_t file = H5Fcreate(out_file_path, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+        if (file < 0) {
+            log_print("ERROR: can not create vtkhdf file: " + std::string(out_file_path));
+            return false;
+        }
+
+        bool res = true;
+        hid_t root = H5Gcreate2(file, "VTKHDF", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+        if (root < 0) {
+            log_print("ERROR: can not create vtkhdf group: VTKHDF");
+            H5Fclose(file);
+            return false;
+        }
+        res &= write_version_attribute(root);
+        res &= write_string_attribute(root, "Type", "UnstructuredGrid");
+
+        res = res && write_scalar(root, "NumberOfPoints", data.numberOfPoints);
+        res = res && write_scalar(root, "NumberOfCells", data.numberOfCell);
+        res = res && write_scalar(root, "NumberOfConnectivityIds", (long long) connectivity.size());
+        res = res && write_dataset<double>(root, "Points", data.pointList, data.numberOfPoints, 3, compression_level);
+        res = res && write_dataset<long long>(root, "Connectivity", connectivity.data(), connectivity.size(), 1, compression_level);
+        res = res && write_dataset<long long>(root, "Offsets", offsets.data(), offsets.size(), 1, compression_level);
+        res = res && write_dataset<unsigned char>(root, "Types", types.data(), types.size(), 1, compression_level);
+
+        hid_t g_fielddata = -1;
+        if (res && (!data.cellDataString.empty() || !data.pointDataString.empty())) {
+            g_fielddata = H5Gcreate2(root, "FieldData", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+            if (g_fielddata < 0) {
+                log_print("ERROR: can not create vtkhdf group: FieldData");
+                H5Gclose(root);
+                H5Fclose(file);
+                return false;
+            }
+        }
+
+        {
+            //set celldata
+            hid_t g_celldata = H5Gcreate2(root, "CellData", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+            if (g_celldata < 0) {
+                log_print("ERROR: can not create vtkhdf group: CellData");
+                if (g_fielddata >= 0)
+                    H5Gclose(g_fielddata);
+                H5Gclose(root);
+                H5Fclose(file);
+                return false;
+            }
+            res = res && write_string_array_map(g_celldata, g_fielddata, data.cellDataString, compression_level);
+            res = res && write_array_map(g_celldata, data.cellDataDouble, compression_level);
+            res = res && write_array_map(g_celldata, data.cellDataFloat, compression_level);
+            res = res && write_array_map(g_celldata, data.cellDataInt, compression_level);
+            res = res && write_array_map(g_celldata, data.cellDataUInt, compression_level);
+            res = res && write_array_map(g_celldata, data.cellDataUInt64, compression_level);
+            res = res && write_array_map(g_celldata, data.cellDataBool, compression_level);
+            H5Gclose(g_celldata);
+        }
+
+        {
+            //set pointdata
+            hid_t g_pointdata = H5Gcreate2(root, "PointData", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+            if (g_pointdata < 0) {
+                log_print("ERROR: can not create vtkhdf group: PointData");
+                if (g_fielddata >= 0)
+                    H5Gclose(g_fielddata);
+                H5Gclose(root);
+                H5Fclose(file);
+                return false;
+            }
+            res = res && write_string_array_map(g_pointdata, g_fielddata, data.pointDataString, compression_level);
+            res = res && write_array_map(g_pointdata, data.pointDataDouble, compression_level);
+            res = res && write_array_map(g_pointdata, data.pointDataFloat, compression_level);
+            res = res && write_array_map(g_pointdata, data.pointDataInt, compression_level);
+            res = res && write_array_map(g_pointdata, data.pointDataUInt, compression_level);
+            res = res && write_array_map(g_pointdata, data.pointDataUInt64, compression_level);
+            res = res && write_array_map(g_pointdata, data.pointDataBool, compression_level);
+            H5Gclose(g_pointdata);
+        }
+
+        if (g_fielddata >= 0)
+            H5Gclose(g_fielddata);
+        H5Gclose(root);
+        H5Fclose(file);
+        return res;
+    }
+
+}
@@ -0,0 +1,499 @@
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <type_traits>
+#include <filesystem>
+
+#include <vtkCellType.h>
+
+#include "mesh_loader.h"
+#include "vtu_xml.h"
+#include "utils/log/log.h"
+#include "utils/string/fast_format.h"
+
+// VTK XML UnstructuredGrid writers that do not go through a vtkUnstructuredGrid copy.
+namespace Mesh_Loader {
+
+    namespace {
+        const int ascii_values_per_line = 6;
+
+        template<typename T>
+        const char *vtk_type_name();
+
+        template<>
+        const char *vtk_type_name<double>() { return "Float64"; }
+
+        template<>
+        const char *vtk_type_name<float>() { return "Float32"; }
+
+        template<>
+        const char *vtk_type_name<int>() { return "Int32"; }
+
+        template<>
+        const char *vtk_type_name<unsigned int>() { return "UInt32"; }
+
+        template<>
+        const char *vtk_type_name<long long>() { return "Int64"; }
+
+        template<>
+        const char *vtk_type_name<unsigned long long>() { return "UInt64"; }
+
+        template<>
+        const char *vtk_type_name<unsigned char>() { return "UInt8"; }
+
+        template<>
+        const char *vtk_type_name<bool>() { return "Int32"; }
+
+        inline char *format_value(char *out, double v) { return format_double(out, v); }
+
+        inline char *format_value(char *out, float v) { return format_float(out, v); }
+
+        inline char *format_value(char *out, int v) { return format_int(out, v); }
+
+        inline char *format_value(char *out, long long v) { return format_int(out, v); }
+
+        inline char *format_value(char *out, bool v) { return format_int(out, v); }
+
+        inline char *format_value(char *out, unsigned int v) { return format_uint(out, v); }
+
+        inline char *format_value(char *out, unsigned long long v) { return format_uint(out, v); }
+
+        inline char *format_value(char *out, unsigned char v) { return format_uint(out, v); }
+
+        inline char *ascii_separator(char *p, size_t i) {
+            *p++ = (i % ascii_values_per_line == ascii_values_per_line - 1) ? '\n' : ' ';
+            return p;
+        }
+
+        void write_array_header(FILE *fp, const char *type, const std::string &name, int components) {
+            fputs(vtu_ascii_array(type, name, components).c_str(), fp);
+        }
+
+        template<typename T>
+        bool write_ascii_array(FILE *fp, const std::string &name, const T *values, size_t n, int components = 1) {
+            write_array_header(fp, vtk_type_name<T>(), name, components);
+            bool res = write_text_parallel(fp, n, max_int_chars + max_double_chars + 1, [values](char *p, size_t i) {
+                p = format_value(p, values[i]);
+                return ascii_separator(p, i);
+            });
+            fprintf(fp, "\n        </DataArray>\n");
+            return res;
+        }
+
+        bool write_ascii_array(FILE *fp, const std::string &name, const std::vector<bool> &values) {
+            write_array_header(fp, vtk_type_name<bool>(), name, 1);
+            bool res = write_text_parallel(fp, values.size(), max_int_chars + 1, [&values](char *p, size_t i) {
+                p = format_value(p, (bool) values[i]);
+                return ascii_separator(p, i);
+            });
+            fprintf(fp, "\n        </DataArray>\n");
+            return res;
+        }
+
+        //same layout as vtkXMLWriter: every char as a number, each string terminated by 0
+        bool write_ascii_array(FILE *fp, const std::string &name, const std::vector<std::string> &values) {
+            size_t max_length = 0;
+            for (const auto &v: values)
+                max_length = std::max(max_length, v.size());
+
+            write_array_header(fp, "String", name, 1);
+            bool res = write_text_parallel(fp, values.size(), (max_length + 1) * 5 + 1, [&values](char *p, size_t i) {
+                for (char c: values[i]) {
+                    p = format_int(p, (signed char) c);
+                    *p++ = ' ';
+                }
+                *p++ = '0';
+                return ascii_separator(p, i);
+            });
+            fprintf(fp, "\n        </DataArray>\n");
+            return res;
+        }
+
+        template<typename T>
+        bool write_ascii_array_map(FILE *fp, const std::map<std::string, DataArray<T>> &arrays) {
+            bool res = true;
+            for (auto iter = arrays.begin(); iter != arrays.end(); iter++) {
+                if constexpr (std::is_same_v<T, bool> || std::is_same_v<T, std::string>)
+                    res &= write_ascii_array(fp, iter->first, iter->second.content);
+                else
+                    res &= write_ascii_array(fp, iter->first, iter->second.content.data(), iter->second.content.size());
+            }
+            return res;
+        }
+
+        // raw appended layout: geometry blocks first at fixed offsets, attribute blocks last, the xml header is padded
+        // so it can be rewritten in place; the geometry hash is kept in a comment of the header
+        const char *geometry_hash_key = "geometry_hash=\"";
+        const char *geometry_bytes_key = "geometry_bytes=\"";
+        const size_t appended_header_padding = 4096;
+
+        struct Geometry_Hash {
+            uint64_t h = 0x9E3779B97F4A7C15ull;
+
+            void add(const void *p, size_t n) {
+                const unsigned char *c = (const unsigned char *) p;
+                for (; n >= 8; n -= 8, c += 8) {
+                    uint64_t w;
+                    memcpy(&w, c, 8);
+                    h = (h ^ w) * 0x100000001B3ull;
+                    h ^= h >> 29;
+                }
+                for (; n > 0; n--, c++)
+                    h = (h ^ *c) * 0x100000001B3ull;
+            }
+        };
+
+        //feeds the geometry blocks (UInt64 byte count + raw values) in a fixed chunking to out(ptr, bytes)
+        template<typename Out>
+        void geometry_blocks(const FileData &data, Out &&out) {
+            const size_t chunk_cells = 1 << 16;
+            uint64_t ids = 0;
+            for (int i = 0; i < data.numberOfCell; i++)
+                ids += data.cellList[i].numberOfPoints;
+
+            uint64_t bytes = (uint64_t) data.numberOfPoints * 3 * sizeof(double);
+            out(&bytes, sizeof(bytes));
+            out(data.pointList, bytes);
+
+            std::vector<int64_t> ids_buffer;
+            bytes = ids * sizeof(int64_t);
+            out(&bytes, sizeof(bytes));
+            for (int b = 0; b < data.numberOfCell; b += chunk_cells) {
+                int e = std::min<int>(data.numberOfCell, b + chunk_cells);
+                ids_buffer.clear();
+                for (int i = b; i < e; i++)
+                    ids_buffer.insert(ids_buffer.end(), data.cellList[i].pointList, data.cellList[i].pointList + data.cellList[i].numberOfPoints);
+                out(ids_buffer.data(), ids_buffer.size() * sizeof(int64_t));
+            }
+
+            bytes = (uint64_t) data.numberOfCell * sizeof(int64_t);
+            out(&bytes, sizeof(bytes));
+            int64_t offset = 0;
+            for (int b = 0; b < data.numberOfCell; b += chunk_cells) {
+                int e = std::min<int>(data.numberOfCell, b + chunk_cells);
+                ids_buffer.clear();
+                for (int i = b; i < e; i++) {
+                    offset += data.cellList[i].numberOfPoints;
+                    ids_buffer.push_back(offset);
+                }
+                out(ids_buffer.data(), ids_buffer.size() * sizeof(int64_t));
+            }
+
+            std::vector<unsigned char> types;
+            bytes = data.numberOfCell;
+            out(&bytes, sizeof(bytes));
+            for (int b = 0; b < data.numberOfCell; b += chunk_cells) {
+                int e = std::min<int>(data.numberOfCell, b + chunk_cells);
+                types.clear();
+                for (int i = b; i < e; i++)
+                    types.push_back(data.cellList[i].numberOfPoints == 4 ? VTK_TETRA : VTK_TRIANGLE);
+                out(types.data(), types.size());
+            }
+        }
+
+        struct Appended_Array {
+            std::string type;
+            std::string name;
+            bool point;
+            std::vector<char> bytes;
+        };
+
+        template<typename T>
+        void collect_appended_arrays(std::vector<Appended_Array> &arrays, const std::map<std::string, DataArray<T>> &source, bool point) {
+            for (auto iter = source.begin(); iter != source.end(); iter++) {
+                const auto &content = iter->second.content;
+                Appended_Array a{"", iter->first, point};
+                if constexpr (std::is_same_v<T, std::string>) {
+                    a.type = "String";
+                    for (const auto &s: content)
+                        a.bytes.insert(a.bytes.end(), s.c_str(), s.c_str() + s.size() + 1);
+                }
+                else if constexpr (std::is_same_v<T, bool>) {
+                    a.type = vtk_type_name<bool>();
+                    a.bytes.resize(content.size() * sizeof(int));
+                    for (size_t i = 0; i < content.size(); i++) {
+                        int v = content[i];
+                        memcpy(&a.bytes[i * sizeof(int)], &v, sizeof(int));
+                    }
+                }
+                else {
+                    a.type = vtk_type_name<T>();
+                    a.bytes.resize(content.size() * sizeof(T));
+                    if (!content.empty())
+                        memcpy(a.bytes.data(), content.data(), a.bytes.size());
+                }
+                arrays.push_back(std::move(a));
+            }
+        }
+
+        std::vector<Appended_Array> collect_appended_arrays(const FileData &data) {
+            std::vector<Appended_Array> arrays;
+            collect_appended_arrays(arrays, data.pointDataString, true);
+            collect_appended_arrays(arrays, data.pointDataDouble, true);
+            collect_appended_arrays(arrays, data.pointDataFloat, true);
+            collect_appended_arrays(arrays, data.pointDataInt, true);
+            collect_appended_arrays(arrays, data.pointDataUInt64, true);
+            collect_appended_arrays(arrays, data.pointDataUInt, true);
+            collect_appended_arrays(arrays, data.pointDataBool, true);
+            collect_appended_arrays(arrays, data.cellDataString, false);
+            collect_appended_arrays(arrays, data.cellDataDouble, false);
+            collect_appended_arrays(arrays, data.cellDataFloat, false);
+            collect_appended_arrays(arrays, data.cellDataInt, false);
+            collect_appended_arrays(arrays, data.cellDataUInt, false);
+            collect_appended_arrays(arrays, data.cellDataUInt64, false);
+            collect_appended_arrays(arrays, data.cellDataBool, false);
+            return arrays;
+        }
+
+        //xml text up to and including the '_' of the appended data, padded to header_size if it is not 0
+        std::string appended_header(const FileData &data, const std::vector<Appended_Array> &arrays, uint64_t geometry_hash,
+                                    uint64_t geometry_bytes, size_t header_size) {
+            std::string header;
+            char line[512];
+            auto array_line = [&](const std::string &type, const std::string &name, int components, uint64_t offset) {
+                header += vtu_appended_array(type, name, components, offset);
+            };
+            uint64_t points_bytes = (uint64_t) data.numberOfPoints * 3 * sizeof(double);
+            uint64_t ids = 0;
+            for (int i = 0; i < data.numberOfCell; i++)
+                ids += data.cellList[i].numberOfPoints;
+
+            header += vtu_file_begin();
+            snprintf(line, sizeof(line), "<!-- f3grid_converter %s%016llx\" %s%llu\" -->\n", geometry_hash_key, (unsigned long long) geometry_hash,
+                     geometry_bytes_key, (unsigned long long) geometry_bytes);
+            header += line;
+            header += vtu_piece_begin(data.numberOfPoints, data.numberOfCell);
+            for (bool point: {true, false}) {
+                header += point ? "      <PointData>\n" : "      <CellData>\n";
+                uint64_t offset = geometry_bytes;
+                for (const auto &a: arrays) {
+                    if (a.point == point)
+                        array_line(a.type, a.name, 1, offset);
+                    offset += sizeof(uint64_t) + a.bytes.size();
+                }
+                header += point ? "      </PointData>\n" : "      </CellData>\n";
+            }
+            header += "      <Points>\n";
+            array_line("Float64", "Points", 3, 0);
+            header += "      </Points>\n";
+            header += "      <Cells>\n";
+            uint64_t offset = sizeof(uint64_t) + points_bytes;
+            array_line("Int64", "connectivity", 1, offset);
+            offset += sizeof(uint64_t) + ids * sizeof(int64_t);
+            array_line("Int64", "offsets", 1, offset);
+            offset += sizeof(uint64_t) + data.numberOfCell * sizeof(int64_t);
+            array_line("UInt8", "types", 1, offset);
+            header += "      </Cells>\n";
+            header += vtu_piece_end();
+            size_t unpadded = header.size() + strlen(vtu_appended_marker);
+            if (header_size == 0)
+                header_size = unpadded + appended_header_padding;
+            if (unpadded + 1 > header_size)
+                return "";
+            header.append(header_size - unpadded - 1, ' ');
+            header += '\n';
+            header += vtu_appended_marker;
+            return header;
+        }
+
+        //returns the number of bytes written
+        uint64_t write_appended_attributes(FILE *fp, const std::vector<Appended_Array> &arrays) {
+            uint64_t written = 0;
+            for (const auto &a: arrays) {
+                uint64_t bytes = a.bytes.size();
+                fwrite(&bytes, sizeof(bytes), 1, fp);
+                if (bytes != 0)
+                    fwrite(a.bytes.data(), 1, bytes, fp);
+                written += sizeof(bytes) + bytes;
+            }
+            fputs(vtu_appended_trailer, fp);
+            return written + strlen(vtu_appended_trailer);
+        }
+
+        //files above 2GB need the 64 bit seek on windows
+        int seek_file(FILE *fp, uint64_t position) {
+#ifdef _WIN32
+            return _fseeki64(fp, position, SEEK_SET);
+#else
+            return fseeko(fp, position, SEEK_SET);
+#endif
+        }
+    }
+
+    bool save_vtu_ascii(const char *out_file_path, const FileData &data) {
+        FILE *fp = fopen(out_file_path, "wb");
+        if (fp == (FILE *) NULL) {
+            log_print("ERROR: can not create vtu file: " + std::string(out_file_path));
+            return false;
+        }
+
+        std::vector<long long> offsets(data.numberOfCell);
+        std::vector<unsigned char> types(data.numberOfCell);
+        long long offset = 0;
+        for (int i = 0; i < data.numberOfCell; i++) {
+            const Cell &cell = data.cellList[i];
+            if (cell.numberOfPoints != 4 && cell.numberOfPoints != 3) {
+                log_print("ERROR: unsupport input");
+                fclose(fp);
+                return false;
+            }
+            types[i] = cell.numberOfPoints == 4 ? VTK_TETRA : VTK_TRIANGLE;
+            offset += cell.numberOfPoints;
+            offsets[i] = offset;
+        }
+
+        fputs(vtu_file_begin().c_str(), fp);
+        fputs(vtu_piece_begin(data.numberOfPoints, data.numberOfCell).c_str(), fp);
+
+        bool res = true;
+        fprintf(fp, "      <PointData>\n");
+        res &= write_ascii_array_map(fp, data.pointDataString);
+        res &= write_ascii_array_map(fp, data.pointDataDouble);
+        res &= write_ascii_array_map(fp, data.pointDataFloat);
+        res &= write_ascii_array_map(fp, data.pointDataInt);
+        res &= write_ascii_array_map(fp, data.pointDataUInt64);
+        res &= write_ascii_array_map(fp, data.pointDataUInt);
+        res &= write_ascii_array_map(fp, data.pointDataBool);
+        fprintf(fp, "      </PointData>\n");
+
+        fprintf(fp, "      <CellData>\n");
+        res &= write_ascii_array_map(fp, data.cellDataString);
+        res &= write_ascii_array_map(fp, data.cellDataDouble);
+        res &= write_ascii_array_map(fp, data.cellDataFloat);
+        res &= write_ascii_array_map(fp, data.cellDataInt);
+        res &= write_ascii_array_map(fp, data.cellDataUInt);
+        res &= write_ascii_array_map(fp, data.cellDataUInt64);
+        res &= write_ascii_array_map(fp, data.cellDataBool);
+        fprintf(fp, "      </CellData>\n");
+
+        fprintf(fp, "      <Points>\n");
+        res &= write_ascii_array(fp, "Points", data.pointList, (size_t) data.numberOfPoints * 3, 3);
+        fprintf(fp, "      </Points>\n");
+
+        fprintf(fp, "      <Cells>\n");
+        write_array_header(fp, "Int64", "connectivity", 1);
+        res &= write_text_parallel(fp, data.numberOfCell, 4 * (max_int_chars + 1), [&data](char *p, size_t i) {
+            const Cell &cell = data.cellList[i];
+            for (int k = 0; k < cell.numberOfPoints; k++) {
+                p = format_int(p, cell.pointList[k]);
+                *p++ = ' ';
+            }
+            p[-1] = '\n';
+            return p;
+        });
+        fprintf(fp, "        </DataArray>\n");
+        res &= write_ascii_array(fp, "offsets", offsets.data(), offsets.size());
+        res &= write_ascii_array(fp, "types", types.data(), types.size());
+        fprintf(fp, "      </Cells>\n");
+
+        fputs(vtu_piece_end().c_str(), fp);
+        fprintf(fp, "</VTKFile>\n");
+
+        res &= ferror(fp) == 0;
+        fclose(fp);
+        return res;
+    }
+
+    bool save_vtu_appended(const char *out_file_path, const FileData &data) {
+        for (int i = 0; i < data.numberOfCell; i++) {
+            if (data.cellList[i].numberOfPoints != 4 && data.cellList[i].numberOfPoints != 3) {
+                log_print("ERROR: unsupport input");
+                return false;
+            }
+        }
+        Geometry_Hash hash;
+        uint64_t geometry_bytes = 0;
+        geometry_blocks(data, [&](const void *p, size_t n) {
+            hash.add(p, n);
+            geometry_bytes += n;
+        });
+        auto arrays = collect_appended_arrays(data);
+
+        FILE *fp = fopen(out_file_path, "wb");
+        if (fp == (FILE *) NULL) {
+            log_print("ERROR: can not create vtu file: " + std::string(out_file_path));
+            return false;
+        }
+        std::string header = appended_header(data, arrays, hash.h, geometry_bytes, 0);
+        fwrite(header.data(), 1, header.size(), fp);
+        geometry_blocks(data, [&](const void *p, size_t n) {
+            if (n != 0)
+                fwrite(p, 1, n, fp);
+        });
+        write_appended_attributes(fp, arrays);
+
+        bool res = ferror(fp) == 0;
+        fclose(fp);
+        return res;
+    }
+
+    bool update_vtu_attributes(const char *out_file_path, const FileData &data) {
+        FILE *fp = fopen(out_file_path, "rb+");
+        if (fp == (FILE *) NULL)
+            return false;
+
+        //the padded header is small, it ends with the appended data marker
+        std::string old_header;
+        {
+            char buffer[65536];
+            size_t n;
+            while (old_header.find(vtu_appended_marker) == std::string::npos && old_header.size() < (1 << 24) &&
+                   (n = fread(buffer, 1, sizeof(buffer), fp)) > 0)
+                old_header.append(buffer, n);
+        }
+        size_t marker = old_header.find(vtu_appended_marker);
+        size_t hash_pos = old_header.find(geometry_hash_key);
+        size_t bytes_pos = old_header.find(geometry_bytes_key);
+        if (marker == std::string::npos || hash_pos == std::string::npos || bytes_pos == std::string::npos || hash_pos > marker) {
+            log_print("WARN: " + std::string(out_file_path) + " was not written in the appended layout, rewrite it");
+            fclose(fp);
+            return false;
+        }
+        size_t header_size = marker + strlen(vtu_appended_marker);
+        uint64_t old_hash = strtoull(old_header.c_str() + hash_pos + strlen(geometry_hash_key), nullptr, 16);
+        uint64_t old_geometry_bytes = strtoull(old_header.c_str() + bytes_pos + strlen(geometry_bytes_key), nullptr, 10);
+
+        Geometry_Hash hash;
+        uint64_t geometry_bytes = 0;
+        geometry_blocks(data, [&](const void *p, size_t n) {
+            hash.add(p, n);
+            geometry_bytes += n;
+        });
+        if (hash.h != old_hash || geometry_bytes != old_geometry_bytes) {
+            log_print("WARN: geometry of " + std::string(out_file_path) + " changed, rewrite it");
+            fclose(fp);
+            return false;
+        }
+
+        auto arrays = collect_appended_arrays(data);
+        std::string header = appended_header(data, arrays, hash.h, geometry_bytes, header_size);
+        if (header.empty()) {
+            log_print("WARN: attribute header of " + std::string(out_file_path) + " does not fit the padding, rewrite it");
+            fclose(fp);
+            return false;
+        }
+
+        //a failed seek would put the header or the attributes in the wrong place, leave the file as it is
+        if (seek_file(fp, 0) != 0) {
+            fclose(fp);
+            return false;
+        }
+        fwrite(header.data(), 1, header.size(), fp);
+        if (seek_file(fp, header_size + geometry_bytes) != 0) {
+            fclose(fp);
+            return false;
+        }
+        uint64_t end = header_size + geometry_bytes + write_appended_attributes(fp, arrays);
+        bool res = ferror(fp) == 0;
+        fclose(fp);
+
+        std::error_code err;
+        std::filesystem::resize_file(out_file_path, end, err);
+        return res && !err;
+    }
+
+}
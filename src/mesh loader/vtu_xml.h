@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// XML pieces shared by the hand written vtu writers (vtu_writer.cpp, f3grid_stream.cpp), not part of the loader api.
+// All of them write the same VTKFile layout: version 1.0, little endian, UInt64 block headers.
+namespace Mesh_Loader {
+
+    //raw appended data starts right after the '_' of the marker, every block is a UInt64 byte count + the bytes
+    inline const char *const vtu_appended_marker = "  <AppendedData encoding=\"raw\">\n   _";
+    inline const char *const vtu_appended_trailer = "\n  </AppendedData>\n</VTKFile>\n";
+
+    inline std::string xml_escape(const std::string &s) {
+        std::string res;
+        for (char c: s) {
+            if (c == '&') res += "&amp;";
+            else if (c == '<') res += "&lt;";
+            else if (c == '>') res += "&gt;";
+            else if (c == '"') res += "&quot;";
+            else res += c;
+        }
+        return res;
+    }
+
+    inline std::string vtu_file_begin() {
+        return "<?xml version=\"1.0\"?>\n"
+               "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt64\">\n";
+    }
+
+    inline std::string vtu_piece_begin(long long point_number, long long cell_number) {
+        return "  <UnstructuredGrid>\n    <Piece NumberOfPoints=\"" + std::to_string(point_number) + "\" NumberOfCells=\"" +
+               std::to_string(cell_number) + "\">\n";
+    }
+
+    inline std::string vtu_piece_end() {
+        return "    </Piece>\n  </UnstructuredGrid>\n";
+    }
+
+    //the attributes of a DataArray element up to the format
+    inline std::string vtu_array_attributes(const std::string &type, const std::string &name, int components) {
+        std::string res = "        <DataArray type=\"" + type + "\" Name=\"" + xml_escape(name) + "\"";
+        if (components > 1)
+            res += " NumberOfComponents=\"" + std::to_string(components) + "\"";
+        return res;
+    }
+
+    //opening tag, the values and "</DataArray>" follow
+    inline std::string vtu_ascii_array(const std::string &type, const std::string &name, int components) {
+        return vtu_array_attributes(type, name, components) + " format=\"ascii\">\n";
+    }
+
+    //empty element, offset is the position of the block after the appended marker
+    inline std::string vtu_appended_array(const std::string &type, const std::string &name, int components, uint64_t offset) {
+        return vtu_array_attributes(type, name, components) + " format=\"appended\" offset=\"" + std::to_string(offset) + "\"/>\n";
+    }
+
+}
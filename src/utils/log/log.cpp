@@ -2,8 +2,12 @@
 // Created by xmyci on 20/02/2024.
 //
 #include "log.h"
+#include <mutex>
 
 void log_print(std::string msg, int level, bool on) {
+    //exports log from several threads, keep their lines whole
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
 
     for (int i = 0; i < level; i++) {
         std::cout << "   ";
@@ -0,0 +1,17 @@
+#include "parallel.h"
+
+int get_thread_number() {
+    static const int thread_number = std::max(1u, std::thread::hardware_concurrency());
+    return thread_number;
+}
+
+//0 until set, so threads that never set it use every hardware thread
+static thread_local int parallel_width = 0;
+
+int get_parallel_width() {
+    return parallel_width > 0 ? parallel_width : get_thread_number();
+}
+
+void set_parallel_width(int width) {
+    parallel_width = std::min(std::max(width, 1), get_thread_number());
+}
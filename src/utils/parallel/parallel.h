@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+
+int get_thread_number();
+
+// Threads a parallel loop started on the calling thread may use: get_thread_number() unless set_parallel_width
+// lowered it for this thread (Task_Pool workers split the hardware threads between them).
+int get_parallel_width();
+
+void set_parallel_width(int width);
+
+// Split [0, n) into chunk_size pieces and run f(chunk_begin, chunk_end, worker_index) on all threads.
+// Chunks are handed out dynamically on get_parallel_width() threads, worker_index is in [0, get_thread_number()).
+template<typename F>
+void parallel_for_chunk(size_t n, size_t chunk_size, F &&f) {
+    if (n == 0)
+        return;
+    chunk_size = std::max<size_t>(chunk_size, 1);
+    size_t chunk_number = (n + chunk_size - 1) / chunk_size;
+    int worker_number = (int) std::min<size_t>(get_parallel_width(), chunk_number);
+
+    if (worker_number <= 1) {
+        for (size_t b = 0; b < n; b += chunk_size)
+            f(b, std::min(n, b + chunk_size), 0);
+        return;
+    }
+
+    std::atomic<size_t> next_chunk(0);
+    auto work = [&](int worker_index) {
+        size_t c;
+        while ((c = next_chunk.fetch_add(1)) < chunk_number) {
+            size_t b = c * chunk_size;
+            f(b, std::min(n, b + chunk_size), worker_index);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int w = 1; w < worker_number; w++)
+        workers.emplace_back(work, w);
+    work(0);
+    for (auto &t: workers)
+        t.join();
+}
+
+template<typename F>
+void parallel_for(size_t n, F &&f, size_t grain_size = 4096) {
+    parallel_for_chunk(n, grain_size, [&](size_t b, size_t e, int) {
+        for (size_t i = b; i < e; i++)
+            f(i);
+    });
+}
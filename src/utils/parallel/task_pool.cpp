@@ -0,0 +1,57 @@
+#include "task_pool.h"
+#include "parallel.h"
+
+Task_Pool::Task_Pool(int concurrency) {
+    if (concurrency <= 0)
+        concurrency = get_thread_number();
+    task_parallel_width = std::max(1, get_thread_number() / concurrency);
+    for (int w = 0; w < concurrency; w++)
+        workers.emplace_back(&Task_Pool::run, this, w);
+}
+
+Task_Pool::~Task_Pool() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    task_ready.notify_all();
+    for (auto &t: workers)
+        t.join();
+}
+
+void Task_Pool::submit(std::function<void(int)> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(std::move(task));
+    }
+    task_ready.notify_one();
+}
+
+void Task_Pool::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    all_done.wait(lock, [&] { return queue.empty() && running == 0; });
+}
+
+void Task_Pool::run(int worker_index) {
+    set_parallel_width(task_parallel_width);
+    while (true) {
+        std::function<void(int)> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            task_ready.wait(lock, [&] { return stopping || !queue.empty(); });
+            if (queue.empty())
+                return;
+            task = std::move(queue.front());
+            queue.pop_front();
+            running++;
+        }
+        task(worker_index);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running--;
+            if (queue.empty() && running == 0)
+                all_done.notify_all();
+        }
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+#include <vector>
+
+// A fixed number of threads running submitted tasks in submit order, used to overlap independent exports.
+// task(worker_index) gets an index in [0, worker_number()) so tasks can share per-worker scratch.
+// Parallel loops inside a task run on get_thread_number() / worker_number() threads, so a full pool of
+// writers that fan out themselves does not start one thread per hardware thread each.
+class Task_Pool {
+public:
+    //concurrency <= 0 means one thread per hardware thread
+    explicit Task_Pool(int concurrency);
+
+    ~Task_Pool();
+
+    Task_Pool(const Task_Pool &) = delete;
+
+    Task_Pool &operator=(const Task_Pool &) = delete;
+
+    int worker_number() const {
+        return (int) workers.size();
+    }
+
+    void submit(std::function<void(int)> task);
+
+    //blocks until every task submitted so far has finished
+    void wait();
+
+private:
+    void run(int worker_index);
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void(int)>> queue;
+    std::mutex mutex;
+    std::condition_variable task_ready, all_done;
+    int running = 0;
+    bool stopping = false;
+    int task_parallel_width = 1;
+};
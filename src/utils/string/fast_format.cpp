@@ -0,0 +1,65 @@
+#include <charconv>
+#include <cstring>
+#include <bit>
+
+#include "fast_format.h"
+
+namespace {
+    const char digit_pairs[201] =
+            "00010203040506070809"
+            "10111213141516171819"
+            "20212223242526272829"
+            "30313233343536373839"
+            "40414243444546474849"
+            "50515253545556575859"
+            "60616263646566676869"
+            "70717273747576777879"
+            "80818283848586878889"
+            "90919293949596979899";
+
+    const unsigned long long power_of_10[20] = {
+            1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull, 1000000000ull,
+            10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull, 100000000000000ull,
+            1000000000000000ull, 10000000000000000ull, 100000000000000000ull, 1000000000000000000ull,
+            10000000000000000000ull};
+
+    int count_digits(unsigned long long value) {
+        //log10 from the bit width, then one compare to correct it
+        value |= 1;
+        int t = (std::bit_width(value) * 1233) >> 12;
+        return t + 1 - (value < power_of_10[t]);
+    }
+}
+
+//the longest shortest round-trip double is 24 chars, e.g. -2.2250738585072014e-308, a float takes at most 15
+char *format_double(char *out, double value) {
+    return std::to_chars(out, out + max_double_chars, value).ptr;
+}
+
+char *format_float(char *out, float value) {
+    return std::to_chars(out, out + max_double_chars, value).ptr;
+}
+
+char *format_uint(char *out, unsigned long long value) {
+    char *end = out + count_digits(value);
+    char *p = end;
+    while (value >= 100) {
+        p -= 2;
+        memcpy(p, digit_pairs + (value % 100) * 2, 2);
+        value /= 100;
+    }
+    if (value >= 10) {
+        p -= 2;
+        memcpy(p, digit_pairs + value * 2, 2);
+    }
+    else {
+        *--p = (char) ('0' + value);
+    }
+    return end;
+}
+
+char *format_int(char *out, long long value) {
+    *out = '-';
+    unsigned long long u = value < 0 ? 0ull - (unsigned long long) value : (unsigned long long) value;
+    return format_uint(out + (value < 0), u);
+}
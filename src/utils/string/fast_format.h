@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdio>
+#include <cstddef>
+#include <vector>
+
+#include "utils/parallel/parallel.h"
+
+//upper bound of chars written by one call (without separator)
+const int max_double_chars = 24;
+const int max_int_chars = 20;
+
+//shortest round-trip representation (std::to_chars)
+char *format_double(char *out, double value);
+
+char *format_float(char *out, float value);
+
+char *format_int(char *out, long long value);
+
+char *format_uint(char *out, unsigned long long value);
+
+// Format items [0, n) and write them to fp in order. Items are formatted in parallel chunks into per-worker
+// buffers, format_item(out, i) must write at most max_item_chars chars and return the new end.
+template<typename F>
+bool write_text_parallel(FILE *fp, size_t n, size_t max_item_chars, F &&format_item, size_t chunk_items = 1 << 15) {
+    int worker_number = get_parallel_width();
+    size_t round_items = chunk_items * worker_number;
+
+    std::vector<std::vector<char>> buffers(worker_number, std::vector<char>(chunk_items * max_item_chars));
+    std::vector<size_t> buffer_size(worker_number);
+
+    for (size_t round_begin = 0; round_begin < n; round_begin += round_items) {
+        size_t round_n = std::min(n - round_begin, round_items);
+        parallel_for_chunk(worker_number, 1, [&](size_t b, size_t, int) {
+            size_t item_begin = round_begin + b * chunk_items;
+            size_t item_end = std::min(round_begin + round_n, item_begin + chunk_items);
+            char *begin = buffers[b].data();
+            char *p = begin;
+            for (size_t i = item_begin; i < item_end; i++)
+                p = format_item(p, i);
+            buffer_size[b] = p - begin;
+        });
+        for (int b = 0; b < worker_number; b++) {
+            if (round_begin + b * chunk_items >= round_begin + round_n)
+                break;
+            if (fwrite(buffers[b].data(), 1, buffer_size[b], fp) != buffer_size[b])
+                return false;
+        }
+    }
+    return true;
+}
@@ -48,14 +48,23 @@ std::wstring utf8str2wstring(const std::string str) {
     return strCnv.from_bytes(str);
 }
 
+//codecvt_byname has a protected destructor, wstring_convert needs a facet it can delete
+template<class Facet>
+struct deletable_facet : Facet {
+    template<class... Args>
+    deletable_facet(Args &&... args) : Facet(std::forward<Args>(args)...) {}
+
+    ~deletable_facet() {}
+};
+
 std::wstring ANSIstri2wstring(const std::string str, const std::string locale) {//GBK转宽字节
-    typedef std::codecvt_byname<wchar_t, char, std::mbstate_t> F;
+    typedef deletable_facet<std::codecvt_byname<wchar_t, char, std::mbstate_t>> F;
     static std::wstring_convert<F> strCnv(new F(locale));
     return strCnv.from_bytes(str);
 }
 
 std::string wstring2ANSIstr(const std::wstring str, const std::string locale) {
-    typedef std::codecvt_byname<wchar_t, char, std::mbstate_t> F;
+    typedef deletable_facet<std::codecvt_byname<wchar_t, char, std::mbstate_t>> F;
     static std::wstring_convert<F> strCnv(new F(locale));
     return strCnv.to_bytes(str);
 }
@@ -0,0 +1,117 @@
+#include <cmath>
+#include <limits>
+#include <random>
+
+#include "test_util.h"
+#include "config/config_loader.h"
+#include "basic/data structure/bvh.h"
+#include "basic/geometrical predicates/ray_triangle_batch.h"
+
+Config config;
+
+namespace {
+    using Geometrical_Predicates::Triangle3d;
+    using Geometrical_Predicates::Triangle_Batch;
+    using Geometrical_Predicates::Ray3d;
+    using Geometrical_Predicates::Ray_Kernel;
+
+    //small random triangles in a unit cube, some of them coplanar copies so ties occur
+    std::vector<Triangle3d> make_triangles(size_t n, std::mt19937 &gen) {
+        std::uniform_real_distribution<double> coord(0, 1), offset(-0.05, 0.05);
+        std::vector<Triangle3d> triangle;
+        while (triangle.size() < n) {
+            base_type::Vector3 c(coord(gen), coord(gen), coord(gen));
+            Triangle3d t{c + base_type::Vector3(offset(gen), offset(gen), offset(gen)),
+                         c + base_type::Vector3(offset(gen), offset(gen), offset(gen)),
+                         c + base_type::Vector3(offset(gen), offset(gen), offset(gen))};
+            triangle.push_back(t);
+            if (triangle.size() % 10 == 0)
+                triangle.push_back(t);
+        }
+        return triangle;
+    }
+
+    //every primitive in one leaf, left children follow their parent, bounds contain what is below them
+    bool valid_tree(const BVH &bvh, const std::vector<Triangle3d> &triangle) {
+        std::vector<int> seen(triangle.size(), 0);
+        auto inside = [](const BVH::Node &outer, const double *low, const double *high) {
+            for (int k = 0; k < 3; k++) {
+                if (low[k] < outer.bound_min[k] || high[k] > outer.bound_max[k])
+                    return false;
+            }
+            return true;
+        };
+        bool valid = true;
+        for (uint32_t i = 0; i < bvh.node.size(); i++) {
+            const auto &n = bvh.node[i];
+            if (n.count == 0) {
+                valid &= i + 1 < bvh.node.size() && n.offset < bvh.node.size() && n.offset > i + 1;
+                valid &= inside(n, bvh.node[i + 1].bound_min, bvh.node[i + 1].bound_max);
+                valid &= inside(n, bvh.node[n.offset].bound_min, bvh.node[n.offset].bound_max);
+                continue;
+            }
+            for (uint32_t j = n.offset; j < n.offset + n.count; j++) {
+                uint32_t p = bvh.primitive[j];
+                seen[p]++;
+                for (const auto &v: {triangle[p].p1, triangle[p].p2, triangle[p].p3}) {
+                    double point[3] = {v.x, v.y, v.z};
+                    valid &= inside(n, point, point);
+                }
+            }
+        }
+        for (int s: seen)
+            valid &= s == 1;
+        return valid;
+    }
+
+    void test_bvh() {
+        std::mt19937 gen(21);
+        for (size_t n: {1u, 7u, 100u, 5000u}) {
+            auto triangle = make_triangles(n, gen);
+            BVH bvh;
+            bvh.build(triangle);
+            CHECK(valid_tree(bvh, triangle));
+
+            Triangle_Batch all, ordered;
+            for (const auto &t: triangle)
+                all.push_back(t);
+            for (auto p: bvh.primitive)
+                ordered.push_back(triangle[p]);
+
+            std::uniform_real_distribution<double> coord(-0.2, 1.2);
+            int hits = 0;
+            bool same = true;
+            for (int r = 0; r < 500; r++) {
+                Ray3d ray{{coord(gen), coord(gen), coord(gen)}, {coord(gen), coord(gen), coord(gen)}};
+                if (r % 5 == 0)
+                    ray.to = {ray.from.x, ray.from.y, coord(gen)}; //axis aligned, zero slab directions
+                double expected_t;
+                int expected = Geometrical_Predicates::nearest_segment_hit(all, 0, all.size(), ray, true, &expected_t, Ray_Kernel::scalar);
+
+                double t;
+                int hit = bvh.nearest_hit(ray.from, ray.to, [&](uint32_t p, double &hit_t) {
+                    Geometrical_Predicates::intersect_segment_batch(all, p, p + 1, ray, true, &hit_t, Ray_Kernel::scalar);
+                    return hit_t <= 1;
+                }, &t);
+                same &= hit == expected && (hit < 0 || t == expected_t);
+
+                hit = bvh.nearest_hit_range(ray.from, ray.to, [&](uint32_t begin, uint32_t end, double &hit_t) {
+                    return Geometrical_Predicates::nearest_segment_hit(ordered, begin, end, ray, true, &hit_t);
+                }, &t);
+                same &= hit == expected && (hit < 0 || t == expected_t);
+                hits += expected >= 0;
+            }
+            CHECK(same);
+            CHECK(n < 5000 || hits > 100);
+        }
+
+        BVH empty;
+        empty.build({});
+        CHECK(empty.nearest_hit({0, 0, 0}, {1, 1, 1}, [](uint32_t, double &) { return true; }) == -1);
+    }
+}
+
+int main() {
+    test_bvh();
+    return test_result();
+}
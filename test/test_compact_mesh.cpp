@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <cmath>
+
+#include "test_util.h"
+#include "config/config_loader.h"
+#include "basic/compact_mesh.h"
+#include "basic/data structure/radix_sort.h"
+
+Config config;
+
+namespace {
+    using base_type::Compact_Tet_Mesh;
+
+    //box mesh with the vertex ids relabeled and the local vertex order of every tet shuffled
+    void make_mesh(Compact_Tet_Mesh &mesh, int n, unsigned seed) {
+        Mesh_Loader::FileData data;
+        make_box_mesh(data, n, 0.2, seed);
+        std::mt19937 gen(seed);
+        std::vector<uint32_t> label(data.numberOfPoints);
+        std::iota(label.begin(), label.end(), 0);
+        std::shuffle(label.begin(), label.end(), gen);
+        mesh.position.resize(data.numberOfPoints);
+        for (int i = 0; i < data.numberOfPoints; i++)
+            mesh.position[label[i]] = {data.pointList[i * 3], data.pointList[i * 3 + 1], data.pointList[i * 3 + 2]};
+        for (int i = 0; i < data.numberOfCell; i++) {
+            uint32_t v[4];
+            for (int k = 0; k < 4; k++)
+                v[k] = label[data.cellList[i].pointList[k]];
+            std::shuffle(v, v + 4, gen);
+            mesh.add_tet(v[0], v[1], v[2], v[3], 0);
+        }
+        free_mesh(data);
+    }
+
+    //the pointer mesh walk: tets around each vertex, two tets sharing three vertices are neighbors
+    //across the face opposite their non-shared vertex
+    std::vector<uint32_t> reference_neighbors(const Compact_Tet_Mesh &mesh) {
+        std::vector<std::vector<uint32_t>> vertex_tets(mesh.vertex_number());
+        for (uint32_t t = 0; t < mesh.tet_number(); t++) {
+            for (int k = 0; k < 4; k++)
+                vertex_tets[mesh.tet_vertex[t * 4 + k]].push_back(t);
+        }
+        auto non_shared = [&mesh](uint32_t t1, uint32_t t2) {
+            int index = -1, shared = 0;
+            for (int k = 0; k < 4; k++) {
+                bool found = false;
+                for (int m = 0; m < 4; m++)
+                    found |= mesh.tet_vertex[t2 * 4 + k] == mesh.tet_vertex[t1 * 4 + m];
+                if (found) shared++;
+                else index = k;
+            }
+            return shared == 3 ? index : -1;
+        };
+
+        std::vector<uint32_t> neighbor(mesh.tet_vertex.size(), Compact_Tet_Mesh::no_half_face);
+        for (uint32_t t1 = 0; t1 < mesh.tet_number(); t1++) {
+            for (int j = 0; j < 4; j++) {
+                for (auto t2: vertex_tets[mesh.tet_vertex[t1 * 4 + j]]) {
+                    int k = t1 == t2 ? -1 : non_shared(t1, t2);
+                    if (k >= 0)
+                        neighbor[t1 * 4 + non_shared(t2, t1)] = t2 * 4 + k;
+                }
+            }
+        }
+        return neighbor;
+    }
+
+    void test_neighbors() {
+        for (unsigned seed: {1u, 2u, 3u}) {
+            Compact_Tet_Mesh mesh;
+            make_mesh(mesh, 4 + seed * 3, seed);
+            mesh.build_neighbors();
+            CHECK(mesh.tet_neighbor == reference_neighbors(mesh));
+
+            //boundary faces are exactly the unmatched half-faces
+            size_t unmatched = std::count(mesh.tet_neighbor.begin(), mesh.tet_neighbor.end(), Compact_Tet_Mesh::no_half_face);
+            int n = 4 + seed * 3;
+            CHECK(unmatched == size_t(n * n * 12));
+        }
+
+        //3 * index_bits() > 64: the key spills into the high word
+        Compact_Tet_Mesh mesh;
+        make_mesh(mesh, 3, 7);
+        uint32_t shift = (1u << 21) - mesh.vertex_number() + 1;
+        for (auto &v: mesh.tet_vertex)
+            v += shift;
+        mesh.position.insert(mesh.position.begin(), shift, {0, 0, 0});
+        CHECK(mesh.index_bits() == 22);
+        mesh.build_neighbors();
+        CHECK(mesh.tet_neighbor == reference_neighbors(mesh));
+    }
+
+    //a face of three tets stays unmatched on all of them, a face of two is matched
+    void test_non_manifold() {
+        Compact_Tet_Mesh mesh;
+        mesh.position = {{0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {0, 0, -1}, {1, 1, 1}, {-1, -1, -1}};
+        mesh.add_tet(0, 1, 2, 3, 0);
+        mesh.add_tet(2, 1, 0, 4, 0);
+        mesh.add_tet(0, 5, 1, 2, 0);
+        mesh.add_tet(6, 0, 1, 3, 0);
+        mesh.build_neighbors();
+        CHECK(mesh.tet_neighbor[0 * 4 + 3] == Compact_Tet_Mesh::no_half_face);
+        CHECK(mesh.tet_neighbor[1 * 4 + 3] == Compact_Tet_Mesh::no_half_face);
+        CHECK(mesh.tet_neighbor[2 * 4 + 1] == Compact_Tet_Mesh::no_half_face);
+        CHECK(mesh.tet_neighbor[0 * 4 + 2] == 3 * 4 + 0);
+        CHECK(mesh.tet_neighbor[3 * 4 + 0] == 0 * 4 + 2);
+        CHECK(std::count(mesh.tet_neighbor.begin(), mesh.tet_neighbor.end(), Compact_Tet_Mesh::no_half_face) == 14);
+    }
+
+    //the boundary is the set of unmatched half-faces, normals are unit and point away from the tet
+    void test_boundary_only() {
+        for (unsigned seed: {4u, 5u}) {
+            Compact_Tet_Mesh mesh;
+            make_mesh(mesh, 5, seed);
+            mesh.build_neighbors();
+            base_type::Boundary_Surface surface;
+            surface.build_boundary_only(mesh);
+
+            std::vector<uint32_t> unmatched;
+            for (uint32_t h = 0; h < mesh.tet_neighbor.size(); h++) {
+                if (mesh.tet_neighbor[h] == Compact_Tet_Mesh::no_half_face)
+                    unmatched.push_back(h);
+            }
+            CHECK(surface.half_face == unmatched);
+
+            bool outward = surface.area.size() == surface.face_number();
+            double total_area = 0;
+            for (size_t f = 0; outward && f < surface.face_number(); f++) {
+                const uint32_t *v = &surface.face_vertex[f * 3];
+                auto centroid = (mesh.position[v[0]] + mesh.position[v[1]] + mesh.position[v[2]]) / 3;
+                auto inside = mesh.position[mesh.tet_vertex[surface.half_face[f]]];
+                auto n = surface.normal(f);
+                outward &= n.dot(centroid - inside) > 0 && std::abs(n.dot(n) - 1) < 1e-12;
+                total_area += surface.area[f];
+            }
+            CHECK(outward);
+            CHECK(total_area > 6 * 4 * 4 && total_area < 6 * 6 * 6);
+        }
+
+        //a face of three tets is dropped on all of them
+        Compact_Tet_Mesh mesh;
+        mesh.position = {{0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {0, 0, -1}, {1, 1, -1}};
+        mesh.add_tet(0, 1, 2, 3, 0);
+        mesh.add_tet(2, 1, 0, 4, 0);
+        mesh.add_tet(0, 5, 1, 2, 0);
+        base_type::Boundary_Surface surface;
+        surface.build_boundary_only(mesh);
+        CHECK(surface.face_number() == 9);
+        CHECK(std::find(surface.half_face.begin(), surface.half_face.end(), 0 * 4 + 3) == surface.half_face.end());
+    }
+
+    //stable against std::stable_sort, enough items for several blocks, equal high digits are skipped
+    void test_radix_sort() {
+        struct Item {
+            uint64_t key;
+            uint32_t index;
+        };
+        std::mt19937_64 gen(11);
+        for (int bits: {16, 40, 64}) {
+            std::vector<Item> items(300000);
+            for (uint32_t i = 0; i < items.size(); i++)
+                items[i] = {gen() >> (64 - bits), i};
+            auto expected = items;
+            std::stable_sort(expected.begin(), expected.end(), [](const Item &a, const Item &b) { return a.key < b.key; });
+            radix_sort(items, 4, [](const Item &item, int d) -> uint32_t {
+                return (item.key >> (d * 16)) & 0xffff;
+            });
+            bool same = true;
+            for (size_t i = 0; i < items.size(); i++)
+                same &= items[i].key == expected[i].key && items[i].index == expected[i].index;
+            CHECK(same);
+        }
+
+        std::vector<Item> single = {{5, 0}};
+        radix_sort(single, 4, [](const Item &item, int d) -> uint32_t { return (item.key >> (d * 16)) & 0xffff; });
+        CHECK(single[0].key == 5);
+    }
+}
+
+int main() {
+    test_neighbors();
+    test_non_manifold();
+    test_boundary_only();
+    test_radix_sort();
+    return test_result();
+}
@@ -0,0 +1,77 @@
+#include <algorithm>
+#include <random>
+
+#include "test_util.h"
+#include "config/config_loader.h"
+#include "basic/data structure/csr.h"
+#include "algorithm/mesh_reorder.h"
+
+Config config;
+
+namespace {
+    //items in a random number of random rows, repeats included, against a serial fill
+    void test_incidence() {
+        std::mt19937 gen(9);
+        const size_t row_number = 5000, item_number = 200000;
+        std::vector<std::vector<uint32_t>> item_rows(item_number);
+        std::uniform_int_distribution<uint32_t> row(0, row_number - 1), count(0, 5);
+        for (auto &rows: item_rows) {
+            rows.resize(count(gen));
+            for (auto &r: rows)
+                r = row(gen);
+        }
+
+        std::vector<std::vector<uint32_t>> expected(row_number + 1);
+        for (uint32_t i = 0; i < item_number; i++) {
+            for (auto r: item_rows[i])
+                expected[r].push_back(i);
+        }
+
+        CSR_Incidence incidence;
+        incidence.build(row_number + 1, item_number, [&](size_t i, auto add) {
+            for (auto r: item_rows[i])
+                add(r);
+        });
+        CHECK(incidence.offset.size() == row_number + 2);
+        bool same = true;
+        for (size_t r = 0; r <= row_number; r++) {
+            same &= incidence.row_size(r) == expected[r].size() &&
+                    std::equal(expected[r].begin(), expected[r].end(), incidence.row_begin(r));
+        }
+        CHECK(same);
+        CHECK(incidence.row_size(row_number) == 0);
+    }
+
+    //the neighbors of a point are the other points of its cells, listed in cell order
+    void test_node_graph() {
+        Mesh_Loader::FileData data;
+        make_box_mesh(data, 4);
+        Node_Graph graph = build_node_graph(data);
+        CHECK(graph.offset.size() == size_t(data.numberOfPoints) + 1);
+
+        bool same = true;
+        for (int i = 0; i < data.numberOfPoints; i++) {
+            std::vector<uint32_t> expected;
+            for (int c = 0; c < data.numberOfCell; c++) {
+                const auto &cell = data.cellList[c];
+                if (std::find(cell.pointList, cell.pointList + cell.numberOfPoints, i) == cell.pointList + cell.numberOfPoints)
+                    continue;
+                for (int k = 0; k < cell.numberOfPoints; k++) {
+                    uint32_t p = cell.pointList[k];
+                    if (p != uint32_t(i) && std::find(expected.begin(), expected.end(), p) == expected.end())
+                        expected.push_back(p);
+                }
+            }
+            same &= graph.degree(i) == expected.size() &&
+                    std::equal(expected.begin(), expected.end(), graph.neighbor.begin() + graph.offset[i]);
+        }
+        CHECK(same);
+        free_mesh(data);
+    }
+}
+
+int main() {
+    test_incidence();
+    test_node_graph();
+    return test_result();
+}
@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <map>
+#include <random>
+
+#include "test_util.h"
+#include "config/config_loader.h"
+#include "basic/typedef.h"
+#include "basic/compact_mesh.h"
+#include "basic/data structure/edge_runs.h"
+
+Config config;
+
+namespace {
+    //runs against a map from the (min, max) pair to its slots
+    void test_runs() {
+        std::mt19937 gen(3);
+        for (size_t vertex_number: {2u, 50u, 70000u}) {
+            std::uniform_int_distribution<uint32_t> vertex(0, vertex_number - 1);
+            std::vector<uint32_t> triangle(30000);
+            for (auto &v: triangle)
+                v = vertex(gen);
+            auto edge_vertex = [&](size_t i) {
+                return std::make_pair(triangle[i], triangle[i - i % 3 + (i + 1) % 3]);
+            };
+
+            std::map<std::pair<uint32_t, uint32_t>, std::vector<uint32_t>> expected;
+            for (size_t i = 0; i < triangle.size(); i++) {
+                auto edge = edge_vertex(i);
+                expected[std::minmax(edge.first, edge.second)].push_back(i);
+            }
+
+            Edge_Runs runs;
+            runs.build(triangle.size(), vertex_number, edge_vertex);
+            CHECK(runs.run_number() == expected.size());
+            bool same = runs.run_number() == expected.size();
+            size_t r = 0;
+            for (auto it = expected.begin(); same && it != expected.end(); ++it, r++) {
+                same &= runs.run_offset[r + 1] - runs.run_offset[r] == it->second.size() &&
+                        std::equal(it->second.begin(), it->second.end(), runs.slot.begin() + runs.run_offset[r]);
+            }
+            CHECK(same);
+        }
+
+        Edge_Runs empty;
+        empty.build(0, 1, [](size_t) { return std::make_pair(0u, 0u); });
+        CHECK(empty.run_number() == 0);
+    }
+
+    //octahedron: 12 edges with 2 faces each, allocated in order of first use, faces in pool order
+    void test_triangle_soup() {
+        using namespace base_type;
+        static const int face_edge[3][2] = {{1, 2}, {0, 2}, {0, 1}};
+        Triangle_Soup_Mesh mesh;
+        const Vector3 position[6] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+        const int triangle[8][3] = {{0, 2, 4}, {2, 1, 4}, {1, 3, 4}, {3, 0, 4}, {2, 0, 5}, {1, 2, 5}, {3, 1, 5}, {0, 3, 5}};
+        std::vector<Vertex *> vertex;
+        for (auto &p: position)
+            vertex.push_back(Vertex::allocate_from_pool(&mesh.vertex_pool, p));
+        for (auto &t: triangle)
+            Face::allocate_from_pool(&mesh.face_pool, vertex[t[0]], vertex[t[1]], vertex[t[2]]);
+        mesh.connect_edge_by_face();
+
+        CHECK(mesh.edge_pool.size() == 12);
+        CHECK(mesh.is_closed());
+        CHECK(mesh.is_manifold_2());
+
+        auto face_index = [&mesh](Face *f) {
+            for (int i = 0; i < mesh.face_pool.size(); i++) {
+                if (mesh.face_pool[i] == (void *) f)
+                    return i;
+            }
+            return -1;
+        };
+        bool slots_match = true, faces_ordered = true;
+        std::vector<int> first_use;
+        for (int i = 0; i < 8; i++) {
+            auto f = (Face *) mesh.face_pool[i];
+            Vertex *p[3] = {f->p1, f->p2, f->p3};
+            for (int k = 0; k < 3; k++) {
+                base_type::Edge *e = f->disjoin_edge[k];
+                Vertex *a = p[face_edge[k][0]], *b = p[face_edge[k][1]];
+                slots_match &= (e->orig == a && e->end == b) || (e->orig == b && e->end == a);
+                slots_match &= std::count(e->connect_face_array, e->connect_face_array + e->connect_face_number, f) == 1;
+                faces_ordered &= std::is_sorted(e->connect_face_array, e->connect_face_array + e->connect_face_number,
+                                                [&](Face *x, Face *y) { return face_index(x) < face_index(y); });
+                int index = -1;
+                for (int j = 0; j < mesh.edge_pool.size(); j++) {
+                    if (mesh.edge_pool[j] == (void *) e)
+                        index = j;
+                }
+                if (std::find(first_use.begin(), first_use.end(), index) == first_use.end())
+                    first_use.push_back(index);
+            }
+        }
+        CHECK(slots_match);
+        CHECK(faces_ordered);
+        bool in_order = first_use.size() == 12;
+        for (int j = 0; in_order && j < 12; j++)
+            in_order &= first_use[j] == j;
+        CHECK(in_order);
+    }
+
+    //box boundary: a closed manifold surface, every face has 3 dual neighbors sharing an edge with it
+    void test_dual_graph() {
+        Mesh_Loader::FileData data;
+        make_box_mesh(data, 5);
+        base_type::Compact_Tet_Mesh mesh;
+        for (int i = 0; i < data.numberOfPoints; i++)
+            mesh.position.push_back({data.pointList[i * 3], data.pointList[i * 3 + 1], data.pointList[i * 3 + 2]});
+        for (int i = 0; i < data.numberOfCell; i++) {
+            auto v = data.cellList[i].pointList;
+            mesh.add_tet(v[0], v[1], v[2], v[3], 0);
+        }
+        free_mesh(data);
+
+        base_type::Boundary_Surface surface;
+        surface.build_boundary_only(mesh);
+        CHECK(surface.face_number() == 5 * 5 * 12);
+        bool valid = surface.dual_offset.size() == surface.face_number() + 1;
+        for (uint32_t f = 0; valid && f < surface.face_number(); f++) {
+            valid &= surface.dual_offset[f + 1] - surface.dual_offset[f] == 3;
+            for (uint32_t i = surface.dual_offset[f]; i < surface.dual_offset[f + 1]; i++) {
+                uint32_t g = surface.dual_face[i];
+                int shared = 0;
+                for (int a = 0; a < 3; a++)
+                    for (int b = 0; b < 3; b++)
+                        shared += surface.face_vertex[f * 3 + a] == surface.face_vertex[g * 3 + b];
+                valid &= shared == 2;
+                valid &= std::count(&surface.dual_face[surface.dual_offset[g]], &surface.dual_face[0] + surface.dual_offset[g + 1], f) == 1;
+            }
+        }
+        CHECK(valid);
+    }
+}
+
+int main() {
+    test_runs();
+    test_triangle_soup();
+    test_dual_graph();
+    return test_result();
+}
@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <array>
+#include <set>
+
+#include "vtk_exodusII.h"
+
+#include "test_util.h"
+#include "config/config_loader.h"
+
+Config config;
+
+int main() {
+    Mesh_Loader::FileData data;
+    make_box_mesh(data, 2);
+
+    //slot 0: three materials and a few ungrouped tets
+    auto &zone = data.cellDataInt["zone_Z"].content;
+    for (int i = 0; i < data.numberOfCell; i++)
+        zone.push_back(i % 7 == 0 ? -1 : i % 3 + 10);
+
+    //two face groups made of tet faces
+    std::vector<Mesh_Loader::FaceGroup> face_groups(2);
+    face_groups[0].name = "left";
+    face_groups[1].name = "right";
+    for (int i = 0; i < 6; i++) {
+        const int *p = data.cellList[i * 5].pointList;
+        auto &g = face_groups[i % 2];
+        g.pointList.insert(g.pointList.end(), {p[1], p[2], p[3]});
+    }
+
+    std::string path = temp_path("test_exodus.exo");
+    CHECK(Mesh_Loader::save_exodus(path.c_str(), data, 0, face_groups));
+
+    int comp_ws = sizeof(double), io_ws = 0;
+    float version = 0;
+    int exoid = ex_open(path.c_str(), EX_READ, &comp_ws, &io_ws, &version);
+    CHECK(exoid >= 0);
+    if (exoid < 0)
+        return test_result();
+
+    ex_init_params init{};
+    CHECK(ex_get_init_ext(exoid, &init) >= 0);
+    CHECK(init.num_dim == 3);
+    CHECK(init.num_nodes == data.numberOfPoints);
+    CHECK(init.num_elem == data.numberOfCell);
+    CHECK(init.num_elem_blk == 4);
+    CHECK(init.num_side_sets == 2);
+
+    std::vector<double> x(data.numberOfPoints), y(data.numberOfPoints), z(data.numberOfPoints);
+    CHECK(ex_get_coord(exoid, x.data(), y.data(), z.data()) >= 0);
+    bool same_points = true;
+    for (int i = 0; i < data.numberOfPoints; i++)
+        same_points &= x[i] == data.pointList[i * 3] && y[i] == data.pointList[i * 3 + 1] && z[i] == data.pointList[i * 3 + 2];
+    CHECK(same_points);
+
+    //blocks in material order, the id map gives back the original cell of every element
+    std::vector<int> id_map(init.num_elem);
+    CHECK(ex_get_id_map(exoid, EX_ELEM_MAP, id_map.data()) >= 0);
+    const char *block_names[4] = {"10", "11", "12", "ungrouped"};
+    const int block_zone[4] = {10, 11, 12, -1};
+    int element = 0;
+    std::set<int> seen_cells;
+    for (int b = 0; b < 4; b++) {
+        char type[MAX_STR_LENGTH + 1] = {};
+        int64_t size = 0, nodes = 0, edges = 0, faces = 0, attributes = 0;
+        CHECK(ex_get_block(exoid, EX_ELEM_BLOCK, b + 1, type, &size, &nodes, &edges, &faces, &attributes) >= 0);
+        CHECK(std::string(type) == "TETRA4");
+        CHECK(nodes == 4);
+
+        char name[MAX_STR_LENGTH + 1] = {};
+        CHECK(ex_get_name(exoid, EX_ELEM_BLOCK, b + 1, name) >= 0);
+        CHECK(std::string(name) == block_names[b]);
+
+        std::vector<int> conn(size * 4);
+        CHECK(ex_get_conn(exoid, EX_ELEM_BLOCK, b + 1, conn.data(), nullptr, nullptr) >= 0);
+        bool same_block = true;
+        for (int64_t e = 0; e < size; e++, element++) {
+            int cell = id_map[element] - 1;
+            same_block &= cell >= 0 && cell < data.numberOfCell && zone[cell] == block_zone[b];
+            seen_cells.insert(cell);
+            for (int k = 0; same_block && k < 4; k++)
+                same_block &= conn[e * 4 + k] == data.cellList[cell].pointList[k] + 1;
+        }
+        CHECK(same_block);
+    }
+    CHECK(element == data.numberOfCell);
+    CHECK(seen_cells.size() == size_t(data.numberOfCell));
+
+    //side sets: the nodes of each (element, side) read back by the exodus library are the group triangles
+    for (int s = 0; s < 2; s++) {
+        char name[MAX_STR_LENGTH + 1] = {};
+        CHECK(ex_get_name(exoid, EX_SIDE_SET, s + 1, name) >= 0);
+        CHECK(std::string(name) == face_groups[s].name);
+
+        int64_t side_number = 0, df_number = 0;
+        CHECK(ex_get_set_param(exoid, EX_SIDE_SET, s + 1, &side_number, &df_number) >= 0);
+        CHECK(side_number == int64_t(face_groups[s].pointList.size() / 3));
+
+        std::vector<int> node_count(side_number), node_list(side_number * 4);
+        CHECK(ex_get_side_set_node_list(exoid, s + 1, node_count.data(), node_list.data()) >= 0);
+        std::set<std::array<int, 3>> expected, found;
+        for (size_t j = 0; j + 2 < face_groups[s].pointList.size(); j += 3) {
+            std::array<int, 3> f = {face_groups[s].pointList[j] + 1, face_groups[s].pointList[j + 1] + 1, face_groups[s].pointList[j + 2] + 1};
+            std::sort(f.begin(), f.end());
+            expected.insert(f);
+        }
+        for (int64_t j = 0; j < side_number; j++) {
+            CHECK(node_count[j] == 3);
+            std::array<int, 3> f = {node_list[j * 3], node_list[j * 3 + 1], node_list[j * 3 + 2]};
+            std::sort(f.begin(), f.end());
+            found.insert(f);
+        }
+        CHECK(found == expected);
+    }
+
+    ex_close(exoid);
+    free_mesh(data);
+    return test_result();
+}
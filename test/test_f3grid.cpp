@@ -0,0 +1,83 @@
+#include <fstream>
+#include <iterator>
+
+#include "test_util.h"
+#include "config/config_loader.h"
+
+Config config;
+
+int main() {
+    config.array_to_number = false;
+    config.export_face_related = true;
+
+    //tets of a box mesh followed by some of their faces as triangles
+    Mesh_Loader::FileData box;
+    make_box_mesh(box, 2);
+    const int triangle_number = 10;
+    Mesh_Loader::FileData data;
+    data.numberOfPoints = box.numberOfPoints;
+    data.pointList = box.pointList;
+    data.numberOfCell = box.numberOfCell + triangle_number;
+    data.cellList = new Mesh_Loader::Cell[data.numberOfCell];
+    std::copy(box.cellList, box.cellList + box.numberOfCell, data.cellList);
+    for (int i = 0; i < triangle_number; i++) {
+        auto &cell = data.cellList[box.numberOfCell + i];
+        cell.numberOfPoints = 3;
+        cell.pointList = box.cellList[i * 4].pointList + 1;
+    }
+
+    auto &zone = data.cellDataString["zone_Z"].content;
+    auto &boundary = data.cellDataString["bc_F"].content;
+    auto &material = data.cellDataInt["MaterialIDs"].content;
+    for (int i = 0; i < data.numberOfCell; i++) {
+        bool tet = data.cellList[i].numberOfPoints == 4;
+        zone.push_back(tet && i % 4 != 0 ? (i % 2 ? "sand" : "clay") : "");
+        boundary.push_back(!tet && i % 3 != 0 ? (i % 2 ? "inlet" : "wall") : "");
+        material.push_back(i % 5);
+    }
+    auto &layer = data.pointDataInt["layer_G"].content;
+    for (int i = 0; i < data.numberOfPoints; i++)
+        layer.push_back(i % 3 - 1);
+
+    std::string path = temp_path("test_f3grid.f3grid");
+    CHECK(Mesh_Loader::save_f3grid(path.c_str(), data));
+
+    std::string text;
+    {
+        std::ifstream in(path, std::ios::binary);
+        text.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    //only the suffixed arrays are groups, the slot names lose the suffix
+    CHECK(text.find("ZGROUP \"sand\" SLOT \"zone\"") != std::string::npos);
+    CHECK(text.find("FGROUP \"inlet\" SLOT \"bc\"") != std::string::npos);
+    CHECK(text.find("GGROUP \"1\" SLOT \"layer\"") != std::string::npos);
+    CHECK(text.find("MaterialIDs") == std::string::npos);
+    CHECK(text.find("GGROUP \"-1\"") == std::string::npos);
+
+    Mesh_Loader::FileData loaded;
+    CHECK(Mesh_Loader::load_f3grid(path.c_str(), loaded));
+    CHECK(loaded.numberOfPoints == data.numberOfPoints);
+    CHECK(loaded.numberOfCell == data.numberOfCell);
+    bool same_points = loaded.numberOfPoints == data.numberOfPoints;
+    for (int i = 0; same_points && i < data.numberOfPoints * 3; i++)
+        same_points &= loaded.pointList[i] == data.pointList[i];
+    CHECK(same_points);
+    bool same_cells = loaded.numberOfCell == data.numberOfCell;
+    for (int i = 0; same_cells && i < data.numberOfCell; i++) {
+        same_cells &= loaded.cellList[i].numberOfPoints == data.cellList[i].numberOfPoints;
+        for (int k = 0; same_cells && k < data.cellList[i].numberOfPoints; k++)
+            same_cells &= loaded.cellList[i].pointList[k] == data.cellList[i].pointList[k];
+    }
+    CHECK(same_cells);
+
+    CHECK(loaded.cellDataString.size() == 2);
+    CHECK(loaded.cellDataInt.empty());
+    CHECK(loaded.cellDataString["zone_Z"].content == zone);
+    CHECK(loaded.cellDataString["bc_F"].content == boundary);
+
+    for (int i = 0; i < triangle_number; i++)
+        data.cellList[box.numberOfCell + i].pointList = nullptr;
+    delete[] data.cellList;
+    free_mesh(box);
+    return test_result();
+}
@@ -0,0 +1,96 @@
+#include <filesystem>
+
+#include "test_util.h"
+#include "config/config_loader.h"
+
+Config config;
+
+namespace {
+    template<typename T>
+    bool same_arrays(const std::map<std::string, Mesh_Loader::DataArray<T>> &a, const std::map<std::string, Mesh_Loader::DataArray<T>> &b) {
+        if (a.size() != b.size())
+            return false;
+        for (auto iter = a.begin(); iter != a.end(); iter++) {
+            auto other = b.find(iter->first);
+            if (other == b.end() || other->second.content != iter->second.content)
+                return false;
+        }
+        return true;
+    }
+
+    bool same_mesh(const Mesh_Loader::FileData &a, const Mesh_Loader::FileData &b) {
+        if (a.numberOfPoints != b.numberOfPoints || a.numberOfCell != b.numberOfCell)
+            return false;
+        for (int i = 0; i < a.numberOfPoints * 3; i++) {
+            if (a.pointList[i] != b.pointList[i])
+                return false;
+        }
+        for (int i = 0; i < a.numberOfCell; i++) {
+            if (a.cellList[i].numberOfPoints != b.cellList[i].numberOfPoints)
+                return false;
+            for (int k = 0; k < a.cellList[i].numberOfPoints; k++) {
+                if (a.cellList[i].pointList[k] != b.cellList[i].pointList[k])
+                    return false;
+            }
+        }
+        return same_arrays(a.cellDataInt, b.cellDataInt) && same_arrays(a.cellDataString, b.cellDataString);
+    }
+}
+
+int main() {
+    //more cells than one streaming window (batch_size is at least 1024), tets and triangles interleaved in runs
+    Mesh_Loader::FileData box;
+    make_box_mesh(box, 8);
+    Mesh_Loader::FileData data;
+    data.numberOfPoints = box.numberOfPoints;
+    data.pointList = box.pointList;
+    std::vector<Mesh_Loader::Cell> cells;
+    for (int i = 0; i < box.numberOfCell; i++) {
+        cells.push_back(box.cellList[i]);
+        if (i % 700 < 20)
+            cells.push_back({3, box.cellList[i].pointList + 1});
+    }
+    data.numberOfCell = cells.size();
+    data.cellList = cells.data();
+    auto &zone = data.cellDataString["zone_Z"].content;
+    auto &rock = data.cellDataString["rock_Z"].content;
+    auto &boundary = data.cellDataString["bc_F"].content;
+    for (int i = 0; i < data.numberOfCell; i++) {
+        bool tet = data.cellList[i].numberOfPoints == 4;
+        zone.push_back(tet && i % 4 ? "zone" + std::to_string(i % 5) : "");
+        rock.push_back(tet && i < 1500 ? "granite" : "");
+        boundary.push_back(!tet && i % 2 ? "wall" : "");
+    }
+
+    std::string f3grid_path = temp_path("test_f3grid_stream.f3grid");
+    CHECK(Mesh_Loader::save_f3grid(f3grid_path.c_str(), data));
+
+    //same mesh as load_f3grid with the same settings
+    for (bool array_to_number: {false, true}) {
+        for (bool face_related: {false, true}) {
+            config.array_to_number = array_to_number;
+            config.export_face_related = face_related;
+            Mesh_Loader::FileData expected;
+            CHECK(Mesh_Loader::load_f3grid(f3grid_path.c_str(), expected));
+
+            std::string vtu_path = temp_path("test_f3grid_stream.vtu");
+            CHECK(Mesh_Loader::convert_f3grid_to_vtu_streaming(f3grid_path.c_str(), vtu_path.c_str(), 1024, array_to_number, face_related));
+            Mesh_Loader::FileData streamed;
+            CHECK(Mesh_Loader::load_vtu(vtu_path.c_str(), streamed));
+            if (!same_mesh(expected, streamed))
+                std::printf("array_to_number %d face_related %d\n", array_to_number, face_related);
+            CHECK(same_mesh(expected, streamed));
+
+            //temp files are removed
+            int temp_files = 0;
+            for (auto &entry: std::filesystem::directory_iterator(std::filesystem::current_path())) {
+                if (entry.path().filename().string().find("test_f3grid_stream.vtu.tmp") == 0)
+                    temp_files++;
+            }
+            CHECK(temp_files == 0);
+        }
+    }
+
+    free_mesh(box);
+    return test_result();
+}
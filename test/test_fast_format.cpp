@@ -0,0 +1,88 @@
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <random>
+
+#include "test_util.h"
+#include "config/config_loader.h"
+#include "utils/string/fast_format.h"
+
+Config config;
+
+namespace {
+    //formats into a guarded buffer: at most max_chars written, nothing past them touched, parses back to value
+    template<typename T, typename F>
+    bool round_trip(T value, F format, int max_chars) {
+        char buffer[64];
+        std::memset(buffer, '#', sizeof(buffer));
+        char *end = format(buffer, value);
+        if (end <= buffer || end - buffer > max_chars)
+            return false;
+        for (char *p = buffer + max_chars; p < buffer + sizeof(buffer); p++)
+            if (*p != '#')
+                return false;
+        T parsed{};
+        auto res = std::from_chars(buffer, end, parsed);
+        if (res.ec != std::errc() || res.ptr != end)
+            return false;
+        if constexpr (std::is_floating_point_v<T>)
+            return std::isnan(value) ? std::isnan(parsed) : (parsed == value && std::signbit(parsed) == std::signbit(value));
+        else
+            return parsed == value;
+    }
+}
+
+int main() {
+    //extremes of every format
+    for (double v: {0.0, -0.0, 1.0, -1.0, std::numeric_limits<double>::denorm_min(), -std::numeric_limits<double>::denorm_min(),
+                    std::numeric_limits<double>::min(), -std::numeric_limits<double>::min(), std::numeric_limits<double>::max(),
+                    std::numeric_limits<double>::lowest(), std::numeric_limits<double>::epsilon(), -2.2250738585072014e-308,
+                    -1.2345678901234567e-300, std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+                    std::numeric_limits<double>::quiet_NaN()})
+        CHECK(round_trip<double>(v, format_double, max_double_chars));
+    for (float v: {0.0f, -0.0f, std::numeric_limits<float>::denorm_min(), -std::numeric_limits<float>::min(),
+                   std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest(), -1.17549435e-38f})
+        CHECK(round_trip<float>(v, format_float, max_double_chars));
+    for (long long v: {0ll, 7ll, -7ll, 10ll, 99ll, 100ll, std::numeric_limits<long long>::max(), std::numeric_limits<long long>::min()})
+        CHECK(round_trip<long long>(v, format_int, max_int_chars));
+    for (unsigned long long v: {0ull, 9ull, 10ull, 1000000000000000000ull, 9999999999999999999ull, std::numeric_limits<unsigned long long>::max()})
+        CHECK(round_trip<unsigned long long>(v, format_uint, max_int_chars));
+
+    //random bit patterns cover every exponent and digit count
+    std::mt19937_64 gen(29);
+    bool all_double = true, all_int = true;
+    for (int i = 0; i < 200000; i++) {
+        uint64_t bits = gen();
+        double d;
+        std::memcpy(&d, &bits, sizeof(d));
+        all_double &= round_trip<double>(d, format_double, max_double_chars);
+        all_int &= round_trip<long long>((long long) bits >> (i % 64), format_int, max_int_chars);
+    }
+    CHECK(all_double);
+    CHECK(all_int);
+
+    //parallel writer keeps the item order
+    std::string path = temp_path("test_fast_format.txt");
+    FILE *fp = fopen(path.c_str(), "wb");
+    CHECK(fp != nullptr);
+    if (fp != nullptr) {
+        const size_t n = 100000;
+        CHECK(write_text_parallel(fp, n, max_int_chars + 1, [](char *out, size_t i) {
+            out = format_uint(out, i * 3);
+            *out++ = '\n';
+            return out;
+        }, 1000));
+        fclose(fp);
+
+        std::string expected;
+        for (size_t i = 0; i < n; i++)
+            expected += std::to_string(i * 3) + "\n";
+        std::ifstream in(path, std::ios::binary);
+        std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        CHECK(content == expected);
+    }
+    return test_result();
+}
@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "test_util.h"
+#include "config/config_loader.h"
+#include "algorithm/mesh_reorder.h"
+
+Config config;
+
+namespace {
+    bool is_permutation(const std::vector<uint32_t> &order, size_t n) {
+        std::vector<bool> seen(n, false);
+        for (auto i: order) {
+            if (i >= n || seen[i])
+                return false;
+            seen[i] = true;
+        }
+        return order.size() == n;
+    }
+
+    //a copy of the coordinates of every cell's points, in cell order
+    std::vector<std::vector<double>> cell_coordinates(const Mesh_Loader::FileData &data) {
+        std::vector<std::vector<double>> res(data.numberOfCell);
+        for (int c = 0; c < data.numberOfCell; c++) {
+            const auto &cell = data.cellList[c];
+            for (int k = 0; k < cell.numberOfPoints; k++)
+                res[c].insert(res[c].end(), data.pointList + cell.pointList[k] * 3, data.pointList + cell.pointList[k] * 3 + 3);
+        }
+        return res;
+    }
+
+    //points, cells and their arrays moved together: original_ids lead back to the loaded mesh, cells without them
+    //kept their order
+    bool same_mesh(const Mesh_Loader::FileData &data, const std::vector<double> &point, const std::vector<std::vector<double>> &cell) {
+        const auto &point_id = data.pointDataUInt64.at("original_ids").content;
+        std::vector<unsigned long long> cell_id(data.numberOfCell);
+        for (size_t c = 0; c < cell_id.size(); c++)
+            cell_id[c] = c;
+        if (data.cellDataUInt64.count("original_ids"))
+            cell_id = data.cellDataUInt64.at("original_ids").content;
+        const auto &x = data.pointDataDouble.at("x").content;
+        const auto &id = data.cellDataInt.at("id").content;
+        if (point_id.size() != size_t(data.numberOfPoints) || cell_id.size() != size_t(data.numberOfCell))
+            return false;
+        bool same = true;
+        for (int i = 0; i < data.numberOfPoints; i++) {
+            same &= std::equal(data.pointList + i * 3, data.pointList + i * 3 + 3, point.begin() + point_id[i] * 3);
+            same &= x[i] == data.pointList[i * 3];
+        }
+        auto now = cell_coordinates(data);
+        for (int c = 0; c < data.numberOfCell; c++)
+            same &= now[c] == cell[cell_id[c]] && id[c] == int(cell_id[c]);
+        return same;
+    }
+
+    Mesh_Loader::FileData make_test_mesh(int n, std::vector<double> &point, std::vector<std::vector<double>> &cell) {
+        Mesh_Loader::FileData data;
+        make_box_mesh(data, n);
+        auto &x = data.pointDataDouble["x"].content;
+        for (int i = 0; i < data.numberOfPoints; i++)
+            x.push_back(data.pointList[i * 3]);
+        auto &id = data.cellDataInt["id"].content;
+        for (int c = 0; c < data.numberOfCell; c++)
+            id.push_back(c);
+        point.assign(data.pointList, data.pointList + data.numberOfPoints * 3);
+        cell = cell_coordinates(data);
+        return data;
+    }
+
+    //on an 8^3 lattice every point owns one top level cell of the curve: the Hilbert order walks to a face neighbor
+    //at every step, Morton and Hilbert both list the points by increasing key
+    void test_curve_order() {
+        std::vector<base_type::Vector3> point;
+        for (int z = 0; z < 8; z++)
+            for (int y = 0; y < 8; y++)
+                for (int x = 0; x < 8; x++)
+                    point.push_back({double(x), double(y), double(z)});
+        std::shuffle(point.begin(), point.end(), std::mt19937(11));
+
+        auto hilbert = space_filling_curve_order(point, Space_Filling_Curve::hilbert);
+        CHECK(is_permutation(hilbert, point.size()));
+        bool adjacent = true;
+        for (size_t i = 1; i < hilbert.size(); i++) {
+            auto d = point[hilbert[i]] - point[hilbert[i - 1]];
+            adjacent &= std::abs(d.x) + std::abs(d.y) + std::abs(d.z) == 1;
+        }
+        CHECK(adjacent);
+
+        auto morton = space_filling_curve_order(point, Space_Filling_Curve::morton);
+        CHECK(is_permutation(morton, point.size()));
+        const uint32_t step = ((1u << curve_key_bits) - 1) / 7;
+        auto key = [&](uint32_t i, auto f) {
+            return f(uint32_t(point[i].x) * step, uint32_t(point[i].y) * step, uint32_t(point[i].z) * step);
+        };
+        bool sorted = true;
+        for (size_t i = 1; i < point.size(); i++) {
+            sorted &= key(morton[i - 1], morton_key) < key(morton[i], morton_key);
+            sorted &= key(hilbert[i - 1], hilbert_key) < key(hilbert[i], hilbert_key);
+        }
+        CHECK(sorted);
+
+        //equal keys keep the input order
+        std::vector<base_type::Vector3> same(5, {1, 2, 3});
+        auto order = space_filling_curve_order(same, Space_Filling_Curve::hilbert);
+        CHECK(std::is_sorted(order.begin(), order.end()) && is_permutation(order, same.size()));
+        CHECK(space_filling_curve_order({}, Space_Filling_Curve::morton).empty());
+    }
+
+    void test_curve_reorder() {
+        for (auto curve: {Space_Filling_Curve::morton, Space_Filling_Curve::hilbert}) {
+            std::vector<double> point;
+            std::vector<std::vector<double>> cell;
+            auto data = make_test_mesh(6, point, cell);
+            reorder_by_space_filling_curve(data, curve);
+            CHECK(same_mesh(data, point, cell));
+            //a second pass permutes original_ids like any other array
+            reorder_by_space_filling_curve(data, curve == Space_Filling_Curve::morton ? Space_Filling_Curve::hilbert : Space_Filling_Curve::morton);
+            CHECK(same_mesh(data, point, cell));
+            free_mesh(data);
+        }
+    }
+
+    //a shuffled numbering has a bandwidth close to the point number, RCM brings it back to a few layers of the box
+    void test_reverse_cuthill_mckee() {
+        std::vector<double> point;
+        std::vector<std::vector<double>> cell;
+        auto data = make_test_mesh(8, point, cell);
+        std::vector<uint32_t> shuffle(data.numberOfPoints);
+        for (uint32_t i = 0; i < shuffle.size(); i++)
+            shuffle[i] = i;
+        std::shuffle(shuffle.begin(), shuffle.end(), std::mt19937(4));
+        permute_points(data, shuffle);
+        CHECK(same_mesh(data, point, cell));
+
+        Node_Graph graph = build_node_graph(data);
+        auto order = reverse_cuthill_mckee_order(graph);
+        CHECK(is_permutation(order, data.numberOfPoints));
+
+        Bandwidth_Profile before, after;
+        reorder_by_reverse_cuthill_mckee(data, before, after);
+        CHECK(before.bandwidth == get_bandwidth_profile(graph).bandwidth);
+        CHECK(after.bandwidth < before.bandwidth && after.profile < before.profile);
+        //9 * 9 points per layer of the box, a neighbor is at most two layers away
+        CHECK(after.bandwidth <= 2 * 9 * 9);
+        CHECK(same_mesh(data, point, cell));
+        Bandwidth_Profile now = get_bandwidth_profile(build_node_graph(data));
+        CHECK(now.bandwidth == after.bandwidth && now.profile == after.profile);
+        free_mesh(data);
+
+        //two components, each numbered in one block
+        Node_Graph two;
+        two.offset = {0, 1, 2, 3, 4};
+        two.neighbor = {2, 3, 0, 1};
+        order = reverse_cuthill_mckee_order(two);
+        CHECK(is_permutation(order, 4));
+        CHECK(get_bandwidth_profile(two, [&] {
+            std::vector<uint32_t> new_index(4);
+            for (uint32_t i = 0; i < 4; i++)
+                new_index[order[i]] = i;
+            return new_index;
+        }()).bandwidth == 1);
+    }
+}
+
+int main() {
+    test_curve_order();
+    test_curve_reorder();
+    test_reverse_cuthill_mckee();
+    return test_result();
+}
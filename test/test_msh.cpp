@@ -0,0 +1,140 @@
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <set>
+
+#include "test_util.h"
+#include "config/config_loader.h"
+
+Config config;
+
+namespace {
+    //reads the binary sections of a save_msh file
+    struct Msh_Reader {
+        std::string content;
+        size_t pos = 0;
+
+        bool seek(const std::string &section) {
+            size_t p = content.find(section + "\n");
+            if (p == std::string::npos)
+                return false;
+            pos = p + section.size() + 1;
+            return true;
+        }
+
+        std::string line() {
+            size_t end = content.find('\n', pos);
+            std::string res = content.substr(pos, end - pos);
+            pos = end + 1;
+            return res;
+        }
+
+        template<typename T>
+        T read() {
+            T value;
+            std::memcpy(&value, content.data() + pos, sizeof(T));
+            pos += sizeof(T);
+            return value;
+        }
+    };
+}
+
+int main() {
+    Mesh_Loader::FileData data;
+    make_box_mesh(data, 2);
+
+    auto &zone = data.cellDataString["zone_Z"].content;
+    for (int i = 0; i < data.numberOfCell; i++)
+        zone.push_back(i % 5 == 0 ? "" : (i % 2 ? "sand" : "clay"));
+
+    std::vector<Mesh_Loader::FaceGroup> face_groups(1);
+    face_groups[0].name = "top";
+    for (int i = 0; i < 4; i++) {
+        const int *p = data.cellList[i * 3].pointList;
+        face_groups[0].pointList.insert(face_groups[0].pointList.end(), {p[0], p[1], p[2]});
+    }
+
+    std::string path = temp_path("test_msh.msh");
+    CHECK(Mesh_Loader::save_msh(path.c_str(), data, 0, face_groups));
+
+    Msh_Reader reader;
+    {
+        std::ifstream in(path, std::ios::binary);
+        reader.content.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    CHECK(reader.seek("$MeshFormat"));
+    CHECK(reader.line() == "4.1 1 8");
+    CHECK(reader.read<int>() == 1);
+
+    CHECK(reader.seek("$PhysicalNames"));
+    CHECK(reader.line() == "4");
+    CHECK(reader.line() == "2 1 \"top\"");
+    CHECK(reader.line() == "3 1 \"clay\"");
+    CHECK(reader.line() == "3 2 \"sand\"");
+    CHECK(reader.line() == "3 3 \"ungrouped\"");
+
+    CHECK(reader.seek("$Nodes"));
+    CHECK(reader.read<size_t>() == 1);
+    CHECK(reader.read<size_t>() == size_t(data.numberOfPoints));
+    reader.read<size_t>();
+    reader.read<size_t>();
+    reader.read<int>();
+    reader.read<int>();
+    reader.read<int>();
+    CHECK(reader.read<size_t>() == size_t(data.numberOfPoints));
+    bool same_nodes = true;
+    for (int i = 0; i < data.numberOfPoints; i++)
+        same_nodes &= reader.read<size_t>() == size_t(i + 1);
+    for (int i = 0; i < data.numberOfPoints * 3; i++)
+        same_nodes &= reader.read<double>() == data.pointList[i];
+    CHECK(same_nodes);
+
+    //three volume blocks by material, one surface block; the tets of a block are in file order
+    CHECK(reader.seek("$Elements"));
+    CHECK(reader.read<size_t>() == 4);
+    size_t element_number = reader.read<size_t>();
+    CHECK(element_number == size_t(data.numberOfCell) + 4);
+    reader.read<size_t>();
+    reader.read<size_t>();
+    const char *block_zone[3] = {"clay", "sand", ""};
+    size_t next_tag = 1;
+    std::set<int> seen_cells;
+    for (int b = 0; b < 3; b++) {
+        CHECK(reader.read<int>() == 3);
+        CHECK(reader.read<int>() == b + 1);
+        CHECK(reader.read<int>() == 4);
+        size_t size = reader.read<size_t>();
+        std::vector<int> cells;
+        for (int i = 0; i < data.numberOfCell; i++)
+            if (zone[i] == block_zone[b])
+                cells.push_back(i);
+        CHECK(size == cells.size());
+        bool same_block = size == cells.size();
+        for (size_t e = 0; same_block && e < size; e++) {
+            same_block &= reader.read<size_t>() == next_tag++;
+            for (int k = 0; k < 4; k++)
+                same_block &= reader.read<size_t>() == size_t(data.cellList[cells[e]].pointList[k] + 1);
+            seen_cells.insert(cells[e]);
+        }
+        CHECK(same_block);
+    }
+    CHECK(seen_cells.size() == size_t(data.numberOfCell));
+
+    CHECK(reader.read<int>() == 2);
+    CHECK(reader.read<int>() == 1);
+    CHECK(reader.read<int>() == 2);
+    CHECK(reader.read<size_t>() == 4);
+    bool same_faces = true;
+    for (int e = 0; e < 4; e++) {
+        same_faces &= reader.read<size_t>() == next_tag++;
+        for (int k = 0; k < 3; k++)
+            same_faces &= reader.read<size_t>() == size_t(face_groups[0].pointList[e * 3 + k] + 1);
+    }
+    CHECK(same_faces);
+    CHECK(reader.line() == "");
+    CHECK(reader.line() == "$EndElements");
+
+    free_mesh(data);
+    return test_result();
+}
@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <random>
+
+#include "test_util.h"
+#include "config/config_loader.h"
+#include "basic/geometrical predicates/robust_predicates.h"
+#include "basic/geometrical predicates/predicates_Shewchuk.h"
+
+Config config;
+
+namespace {
+    using namespace Geometrical_Predicates;
+
+    int exact_sign(Vector3 a, Vector3 b, Vector3 c, Vector3 d) {
+        double pa[3] = {a.x, a.y, a.z}, pb[3] = {b.x, b.y, b.z}, pc[3] = {c.x, c.y, c.z}, pd[3] = {d.x, d.y, d.z};
+        double det = orient3dexact(pa, pb, pc, pd);
+        return (det > 0) - (det < 0);
+    }
+
+    //far-off (UTM-like) coordinates, random, nearly coplanar, on an edge, exactly coplanar and repeated points:
+    //the per-query, the static and the batch filters all agree with the exact sign
+    void test_filters() {
+        exactinit(0, 0, 1, 0, 0, 0);
+        std::mt19937 gen(3);
+        std::uniform_real_distribution<double> u(0, 1000);
+        std::uniform_int_distribution<int> grid(0, 1000);
+        const int n = 20000;
+        std::vector<Vector3> a(n), b(n), c(n), d(n);
+        for (int i = 0; i < n; i++) {
+            Vector3 origin(5e5 + u(gen), 4e6 + u(gen), u(gen));
+            a[i] = origin + Vector3(u(gen), u(gen), u(gen));
+            b[i] = origin + Vector3(u(gen), u(gen), u(gen));
+            c[i] = origin + Vector3(u(gen), u(gen), u(gen));
+            switch (i % 5) {
+                case 0:
+                    d[i] = origin + Vector3(u(gen), u(gen), u(gen));
+                    break;
+                case 1: {
+                    double s = u(gen) / 1000, t = u(gen) / 1000;
+                    d[i] = a[i] + (b[i] - a[i]) * s + (c[i] - a[i]) * t;
+                    break;
+                }
+                case 2:
+                    d[i] = a[i] + (b[i] - a[i]) * 0.5;
+                    break;
+                case 3:
+                    //integer points on the plane z = 7, exactly coplanar
+                    a[i] = {double(grid(gen)), double(grid(gen)), 7};
+                    b[i] = {double(grid(gen)), double(grid(gen)), 7};
+                    c[i] = {double(grid(gen)), double(grid(gen)), 7};
+                    d[i] = {double(grid(gen)), double(grid(gen)), 7};
+                    break;
+                default:
+                    d[i] = b[i];
+            }
+        }
+
+        Vector3 low = a[0], high = a[0];
+        for (auto *points: {&a, &b, &c, &d}) {
+            for (const auto &p: *points) {
+                for (int k = 0; k < 3; k++) {
+                    low[k] = std::min(low[k], p[k]);
+                    high[k] = std::max(high[k], p[k]);
+                }
+            }
+        }
+        Orient3d_Filter filter(high - low);
+        std::vector<int> batch(n);
+        orient3d_sign_batch(filter, a.data(), b.data(), c.data(), d.data(), n, batch.data());
+
+        int zeros = 0, positive = 0;
+        bool same = true;
+        for (int i = 0; i < n; i++) {
+            int expected = exact_sign(a[i], b[i], c[i], d[i]);
+            zeros += expected == 0;
+            positive += expected > 0;
+            same &= orient3d_sign(a[i], b[i], c[i], d[i]) == expected;
+            same &= orient3d_sign(filter, a[i], b[i], c[i], d[i]) == expected;
+            same &= batch[i] == expected;
+        }
+        CHECK(same);
+        CHECK(zeros >= n * 2 / 5);
+        CHECK(positive > n / 10 && positive < n / 2);
+
+        //the sign convention: d below the counterclockwise triangle a, b, c is positive
+        CHECK(orient3d_sign({0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, -1}) > 0);
+        CHECK(orient3d_sign({0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1}) < 0);
+    }
+}
+
+int main() {
+    test_filters();
+    return test_result();
+}
@@ -0,0 +1,75 @@
+#include <cmath>
+
+#include "test_util.h"
+#include "config/config_loader.h"
+
+Config config;
+
+namespace {
+    template<typename T>
+    double max_error(const std::vector<T> &a, const std::vector<T> &b) {
+        if (a.size() != b.size())
+            return INFINITY;
+        double res = 0;
+        for (size_t i = 0; i < a.size(); i++)
+            res = std::max(res, std::fabs(double(a[i]) - double(b[i])));
+        return res;
+    }
+}
+
+int main() {
+    Mesh_Loader::FileData data;
+    make_box_mesh(data, 4);
+    //far from the origin, like survey coordinates
+    for (int i = 0; i < data.numberOfPoints * 3; i++)
+        data.pointList[i] = data.pointList[i] * 37.5 + 4.0e5;
+
+    auto &pressure = data.cellDataDouble["pressure"].content;
+    auto &velocity = data.pointDataFloat["velocity"].content;
+    auto &zone = data.cellDataString["zone_Z"].content;
+    auto &id = data.cellDataInt["id"].content;
+    auto &node = data.pointDataUInt64["node"].content;
+    for (int i = 0; i < data.numberOfCell; i++) {
+        pressure.push_back(std::sin(i * 0.01) * 1.0e3);
+        zone.push_back(i % 3 ? "rock" : "");
+        id.push_back(i * 13 - 500);
+    }
+    for (int i = 0; i < data.numberOfPoints; i++) {
+        velocity.push_back(float(std::cos(i * 0.02)));
+        node.push_back(1ull << 40 | i);
+    }
+
+    for (double tolerance: {1.0e-3, 0.5, 0.0}) {
+        std::string path = temp_path("test_preview.f3zp");
+        CHECK(Mesh_Loader::save_preview(path.c_str(), data, tolerance, tolerance));
+
+        Mesh_Loader::FileData loaded;
+        CHECK(Mesh_Loader::load_preview(path.c_str(), loaded));
+        CHECK(loaded.numberOfPoints == data.numberOfPoints);
+        CHECK(loaded.numberOfCell == data.numberOfCell);
+        if (loaded.numberOfPoints != data.numberOfPoints || loaded.numberOfCell != data.numberOfCell)
+            continue;
+
+        //lossy parts within the tolerance (exact when it is 0)
+        std::vector<double> points(data.pointList, data.pointList + data.numberOfPoints * 3);
+        std::vector<double> loaded_points(loaded.pointList, loaded.pointList + loaded.numberOfPoints * 3);
+        CHECK(max_error(points, loaded_points) <= tolerance);
+        CHECK(max_error(pressure, loaded.cellDataDouble["pressure"].content) <= tolerance);
+        CHECK(max_error(velocity, loaded.pointDataFloat["velocity"].content) <= tolerance);
+
+        //topology and the other arrays are lossless
+        bool same_cells = true;
+        for (int i = 0; i < data.numberOfCell; i++) {
+            same_cells &= loaded.cellList[i].numberOfPoints == 4;
+            for (int k = 0; same_cells && k < 4; k++)
+                same_cells &= loaded.cellList[i].pointList[k] == data.cellList[i].pointList[k];
+        }
+        CHECK(same_cells);
+        CHECK(loaded.cellDataString["zone_Z"].content == zone);
+        CHECK(loaded.cellDataInt["id"].content == id);
+        CHECK(loaded.pointDataUInt64["node"].content == node);
+    }
+
+    free_mesh(data);
+    return test_result();
+}
@@ -0,0 +1,82 @@
+#include <cmath>
+#include <random>
+
+#include "test_util.h"
+#include "config/config_loader.h"
+#include "basic/geometrical predicates/ray_triangle_batch.h"
+
+Config config;
+
+namespace {
+    using namespace Geometrical_Predicates;
+
+    //random triangles plus degenerate ones (a point, a line) and segments parallel to a face
+    Triangle_Batch make_batch(std::mt19937 &gen) {
+        std::uniform_real_distribution<double> coord(0, 10), offset(-2, 2);
+        Triangle_Batch batch;
+        for (int i = 0; i < 1003; i++) {
+            Vector3 c(coord(gen), coord(gen), coord(gen));
+            batch.push_back({c + Vector3(offset(gen), offset(gen), offset(gen)), c + Vector3(offset(gen), offset(gen), offset(gen)),
+                             c + Vector3(offset(gen), offset(gen), offset(gen))});
+        }
+        batch.push_back({{1, 1, 1}, {1, 1, 1}, {1, 1, 1}});
+        batch.push_back({{0, 0, 0}, {1, 1, 1}, {2, 2, 2}});
+        batch.push_back({{0, 0, 5}, {10, 0, 5}, {0, 10, 5}});
+        return batch;
+    }
+
+    //every kernel the cpu runs gives the scalar parameters, with and without the border
+    void test_kernels() {
+        std::mt19937 gen(17);
+        auto batch = make_batch(gen);
+        std::uniform_real_distribution<double> coord(-1, 11);
+        std::vector<double> expected(batch.size()), t(batch.size());
+        int hits = 0;
+        bool same = true;
+        for (int r = 0; r < 300; r++) {
+            Ray3d ray{{coord(gen), coord(gen), coord(gen)}, {coord(gen), coord(gen), coord(gen)}};
+            if (r % 7 == 0)
+                ray.to.z = ray.from.z = 5; //in the plane of the last triangle
+            for (bool border: {false, true}) {
+                intersect_segment_batch(batch, 0, batch.size(), ray, border, expected.data(), Ray_Kernel::scalar);
+                for (double v: expected)
+                    hits += v <= 1;
+                for (auto kernel: {Ray_Kernel::avx2, Ray_Kernel::avx512}) {
+                    //odd ranges exercise the masked tails
+                    size_t begin = r % 5, end = batch.size() - r % 3;
+                    intersect_segment_batch(batch, begin, end, ray, border, t.data(), kernel);
+                    for (size_t i = begin; i < end; i++)
+                        same &= t[i - begin] == expected[i];
+                }
+            }
+        }
+        CHECK(same);
+        CHECK(hits > 100);
+        CHECK(ray_kernel_name(detect_ray_kernel()) != nullptr);
+    }
+
+    //closest hit wins, equal parameters go to the larger index, the border rule decides edge hits
+    void test_nearest() {
+        Triangle_Batch batch;
+        batch.push_back({{0, 0, 2}, {4, 0, 2}, {0, 4, 2}});
+        batch.push_back({{0, 0, 1}, {4, 0, 1}, {0, 4, 1}});
+        batch.push_back({{0, 0, 1}, {4, 0, 1}, {0, 4, 1}});
+        batch.push_back({{0, 0, 3}, {4, 0, 3}, {0, 4, 3}});
+        for (auto kernel: {Ray_Kernel::scalar, Ray_Kernel::avx2, Ray_Kernel::avx512}) {
+            double t;
+            CHECK(nearest_segment_hit(batch, 0, batch.size(), {{1, 1, 0}, {1, 1, 4}}, false, &t, kernel) == 2);
+            CHECK(t == 0.25);
+            CHECK(nearest_segment_hit(batch, 0, 2, {{1, 1, 0}, {1, 1, 4}}, false, &t, kernel) == 1);
+            CHECK(nearest_segment_hit(batch, 0, batch.size(), {{1, 1, 0}, {1, 1, 0.5}}, false, &t, kernel) == -1);
+            //through the edge x = 0 of every triangle
+            CHECK(nearest_segment_hit(batch, 0, batch.size(), {{0, 1, 0}, {0, 1, 4}}, false, &t, kernel) == -1);
+            CHECK(nearest_segment_hit(batch, 0, batch.size(), {{0, 1, 0}, {0, 1, 4}}, true, &t, kernel) == 2);
+        }
+    }
+}
+
+int main() {
+    test_kernels();
+    test_nearest();
+    return test_result();
+}
@@ -0,0 +1,74 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "test_util.h"
+#include "config/config_loader.h"
+#include "utils/parallel/task_pool.h"
+#include "utils/parallel/parallel.h"
+
+Config config;
+
+namespace {
+    //every task runs once before wait returns, on a valid worker, never more at once than there are workers
+    void test_pool(int concurrency) {
+        Task_Pool pool(concurrency);
+        CHECK(pool.worker_number() == (concurrency <= 0 ? get_thread_number() : concurrency));
+        pool.wait();
+
+        const int task_number = 200;
+        std::vector<std::atomic<int>> run(task_number);
+        for (auto &r: run)
+            r.store(0);
+        std::atomic<int> active(0), most_active(0), bad_worker(0), bad_width(0);
+        const int width = std::max(1, get_thread_number() / pool.worker_number());
+        for (int i = 0; i < task_number; i++) {
+            pool.submit([&, i](int worker) {
+                int now = ++active;
+                int seen = most_active.load();
+                while (now > seen && !most_active.compare_exchange_weak(seen, now));
+                if (worker < 0 || worker >= pool.worker_number())
+                    bad_worker++;
+                if (get_parallel_width() != width)
+                    bad_width++;
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+                run[i]++;
+                active--;
+            });
+        }
+        pool.wait();
+        bool once = true;
+        for (auto &r: run)
+            once &= r.load() == 1;
+        CHECK(once);
+        CHECK(most_active.load() <= pool.worker_number());
+        CHECK(bad_worker.load() == 0);
+        CHECK(bad_width.load() == 0);
+
+        //parallel loops inside a task still cover the whole range
+        std::atomic<long long> sum(0);
+        pool.submit([&](int) {
+            parallel_for(10000, [&](size_t i) { sum += i; }, 16);
+        });
+        pool.wait();
+        CHECK(sum.load() == 10000LL * 9999 / 2);
+    }
+
+    //the destructor runs what is still queued
+    void test_drain() {
+        std::atomic<int> done(0);
+        {
+            Task_Pool pool(2);
+            for (int i = 0; i < 20; i++)
+                pool.submit([&](int) { done++; });
+        }
+        CHECK(done.load() == 20);
+    }
+}
+
+int main() {
+    for (int concurrency: {1, 3, 0})
+        test_pool(concurrency);
+    test_drain();
+    return test_result();
+}
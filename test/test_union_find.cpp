@@ -0,0 +1,61 @@
+#include <numeric>
+#include <random>
+
+#include "test_util.h"
+#include "config/config_loader.h"
+#include "basic/data structure/union_find.h"
+#include "utils/parallel/parallel.h"
+
+Config config;
+
+namespace {
+    //serial reference with path compression
+    uint32_t find_root(std::vector<uint32_t> &parent, uint32_t x) {
+        while (parent[x] != x)
+            x = parent[x] = parent[parent[x]];
+        return x;
+    }
+
+    //random unions from all threads at once give the serial partition, every root is the smallest index of its set
+    void test_concurrent_unite() {
+        std::mt19937 gen(13);
+        for (size_t n: {1u, 10u, 100000u}) {
+            std::uniform_int_distribution<uint32_t> index(0, n - 1);
+            std::vector<std::pair<uint32_t, uint32_t>> pairs(n * 3 / 4);
+            for (auto &p: pairs)
+                p = {index(gen), index(gen)};
+
+            std::vector<uint32_t> parent(n);
+            std::iota(parent.begin(), parent.end(), 0);
+            for (auto &p: pairs) {
+                uint32_t a = find_root(parent, p.first), b = find_root(parent, p.second);
+                parent[std::max(a, b)] = std::min(a, b);
+            }
+
+            Concurrent_Union_Find sets(n);
+            parallel_for(pairs.size(), [&](size_t i) {
+                sets.unite(pairs[i].first, pairs[i].second);
+            }, 64);
+            std::vector<uint32_t> root(n);
+            parallel_for(n, [&](size_t i) {
+                root[i] = sets.find(i);
+            }, 64);
+
+            bool same = true;
+            std::vector<uint32_t> smallest(n, UINT32_MAX);
+            for (uint32_t i = 0; i < n; i++) {
+                uint32_t expected = find_root(parent, i);
+                smallest[expected] = std::min(smallest[expected], i);
+                same &= root[i] == expected;
+            }
+            for (uint32_t i = 0; i < n; i++)
+                same &= root[i] == smallest[root[i]];
+            CHECK(same);
+        }
+    }
+}
+
+int main() {
+    test_concurrent_unite();
+    return test_result();
+}
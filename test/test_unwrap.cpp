@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+
+#include "test_util.h"
+#include "algorithm/extract_six_surface.h"
+
+Config config;
+
+namespace {
+    //every exported surface cell is a boundary face of its bulk tet, MaterialIDs is the group of that tet
+    void check_patch(const Unwrap &up, const Mesh_Loader::FileData &bulk, const Mesh_Loader::FileData &patch,
+                     const std::vector<int> &group_ids) {
+        auto node_iter = patch.pointDataUInt64.find("bulk_node_ids");
+        auto element_iter = patch.cellDataUInt64.find("bulk_element_ids");
+        auto material_iter = patch.cellDataInt.find("MaterialIDs");
+        CHECK(node_iter != patch.pointDataUInt64.end());
+        CHECK(element_iter != patch.cellDataUInt64.end());
+        CHECK(material_iter != patch.cellDataInt.end());
+        if (node_iter == patch.pointDataUInt64.end() || element_iter == patch.cellDataUInt64.end() || material_iter == patch.cellDataInt.end())
+            return;
+        const auto &bulk_node_ids = node_iter->second.content;
+        const auto &bulk_element_ids = element_iter->second.content;
+        const auto &material = material_iter->second.content;
+
+        bool same_points = bulk_node_ids.size() == size_t(patch.numberOfPoints);
+        for (int i = 0; same_points && i < patch.numberOfPoints; i++) {
+            for (int k = 0; k < 3; k++)
+                same_points &= patch.pointList[i * 3 + k] == bulk.pointList[bulk_node_ids[i] * 3 + k];
+        }
+        CHECK(same_points);
+        //every point once, in bulk order
+        CHECK(std::adjacent_find(bulk_node_ids.begin(), bulk_node_ids.end(), [](uint64_t a, uint64_t b) { return a >= b; }) == bulk_node_ids.end());
+
+        bool same_cells = bulk_element_ids.size() == size_t(patch.numberOfCell) && material.size() == size_t(patch.numberOfCell);
+        for (int j = 0; same_cells && j < patch.numberOfCell; j++) {
+            const auto &tet = bulk.cellList[bulk_element_ids[j]];
+            int shared = 0;
+            for (int k = 0; k < 3; k++) {
+                auto v = bulk_node_ids[patch.cellList[j].pointList[k]];
+                for (int m = 0; m < 4; m++)
+                    shared += tet.pointList[m] == int(v);
+            }
+            same_cells &= shared == 3 && material[j] == group_ids[bulk_element_ids[j]];
+        }
+        CHECK(same_cells);
+    }
+
+    //a ball (slightly jittered, so no ray runs along an edge): its boundary is one connected curved surface and
+    //near the cube corners the normals are closer to a diagonal than to any axis; every face of a side must stay
+    //within 45 degrees of that side's axis, the faces in between belong to no side
+    void check_curved() {
+        Mesh_Loader::FileData data;
+        const int n = 8;
+        make_box_mesh(data, n, 0.05);
+        for (int i = 0; i < data.numberOfPoints; i++) {
+            double *p = &data.pointList[i * 3];
+            double x = p[0] / n * 2 - 1, y = p[1] / n * 2 - 1, z = p[2] / n * 2 - 1;
+            p[0] = 4 * x * std::sqrt(std::max(0.0, 1 - y * y / 2 - z * z / 2 + y * y * z * z / 3));
+            p[1] = 4 * y * std::sqrt(std::max(0.0, 1 - z * z / 2 - x * x / 2 + z * z * x * x / 3));
+            p[2] = 4 * z * std::sqrt(std::max(0.0, 1 - x * x / 2 - y * y / 2 + x * x * y * y / 3));
+        }
+        Unwrap up;
+        CHECK(up.init_from_filedata(data));
+        Unwrap_01(up, {0, 0, 0});
+        CHECK(up.phy_group_array.size() == 6);
+
+        const base_type::Vector3 axis[6] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+        const double limit = std::cos(45.0 * M_PI / 180.0);
+        bool within = true;
+        size_t side_faces = 0;
+        for (int d = 0; d < 6; d++) {
+            CHECK(!up.phy_group_array[d].face_array.empty());
+            for (auto f: up.phy_group_array[d].face_array)
+                within &= up.surface.normal(f).dot(axis[d]) > limit;
+            side_faces += up.phy_group_array[d].face_array.size();
+        }
+        CHECK(within);
+        CHECK(side_faces < up.surface.face_number());
+        free_mesh(data);
+    }
+}
+
+int main() {
+    Mesh_Loader::FileData data;
+    make_box_mesh(data, 6);
+    auto &zone = data.cellDataString["zone_Z"].content;
+    auto &layer = data.cellDataInt["layer_Z"].content;
+    for (int i = 0; i < data.numberOfCell; i++) {
+        zone.push_back(i % 7 == 0 ? "" : (i % 2 ? "sand" : "clay"));
+        layer.push_back(i / 100);
+    }
+
+    Unwrap up;
+    CHECK(up.init_from_filedata(data));
+    CHECK(up.surface.face_number() == 6 * 6 * 6 * 2);
+
+    //MaterialIDs follow the slot of the job: the ids of get_cell_group_ids, like the exodus blocks
+    for (int slot: {0, 1}) {
+        std::vector<int> group_ids;
+        std::vector<std::string> group_names;
+        CHECK(Mesh_Loader::get_cell_group_ids(data, slot, group_ids, group_names));
+        CHECK(up.set_tet_type(data, slot));
+        Unwrap_01(up, {0, 0, 0});
+        CHECK(up.phy_group_array.size() == 6);
+
+        for (int i = 0; i < 6; i++) {
+            Mesh_Loader::FileData patch;
+            up.get_patch_data(i, patch);
+            CHECK(patch.numberOfCell == 6 * 6 * 2);
+            check_patch(up, data, patch, group_ids);
+        }
+    }
+
+    //the files written on the pool read back the same, the merged file carries patch_id as well
+    std::string dir = (std::filesystem::current_path() / "test_unwrap_out").string();
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    std::vector<int> group_ids;
+    std::vector<std::string> group_names;
+    Mesh_Loader::get_cell_group_ids(data, 0, group_ids, group_names);
+    up.set_tet_type(data, 0);
+    Unwrap_01(up, {0, 0, 0});
+    {
+        Task_Pool pool(3);
+        up.save_file(dir, pool);
+        pool.wait();
+    }
+    for (int i = 0; i < 6; i++) {
+        Mesh_Loader::FileData patch;
+        CHECK(Mesh_Loader::load_vtu((dir + "/" + std::to_string(i) + ".vtu").c_str(), patch));
+        check_patch(up, data, patch, group_ids);
+    }
+    CHECK(up.save_merged_file(dir));
+    {
+        Mesh_Loader::FileData merged;
+        CHECK(Mesh_Loader::load_vtu((dir + "/boundary.vtu").c_str(), merged));
+        CHECK(merged.numberOfCell == 6 * 6 * 6 * 2);
+        CHECK(merged.cellDataInt["patch_id"].content.size() == size_t(merged.numberOfCell));
+        //32 bit bulk ids in the merged file, widen them for the shared checks
+        for (auto name: {"bulk_element_ids"}) {
+            auto &content = merged.cellDataUInt[name].content;
+            merged.cellDataUInt64[name].content.assign(content.begin(), content.end());
+        }
+        auto &node_ids = merged.pointDataUInt["bulk_node_ids"].content;
+        merged.pointDataUInt64["bulk_node_ids"].content.assign(node_ids.begin(), node_ids.end());
+        check_patch(up, data, merged, group_ids);
+    }
+
+    //no group arrays: no MaterialIDs
+    {
+        Mesh_Loader::FileData plain;
+        make_box_mesh(plain, 2);
+        Unwrap plain_up;
+        plain_up.init_from_filedata(plain);
+        CHECK(!plain_up.set_tet_type(plain, 0));
+        Unwrap_01(plain_up, {0, 0, 0});
+        Mesh_Loader::FileData patch;
+        plain_up.get_patch_data(0, patch);
+        CHECK(patch.cellDataInt.count("MaterialIDs") == 0);
+        free_mesh(plain);
+    }
+
+    check_curved();
+
+    free_mesh(data);
+    return test_result();
+}
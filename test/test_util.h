@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include <filesystem>
+
+#include "mesh loader/mesh_loader.h"
+
+// Minimal check macro: report the failing expression and keep going, main returns test_result().
+inline int &test_failures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(expr) do { \
+        if (!(expr)) { \
+            std::printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #expr); \
+            test_failures()++; \
+        } \
+    } while (0)
+
+inline int test_result() {
+    if (test_failures() == 0)
+        std::printf("all checks passed\n");
+    return test_failures() == 0 ? 0 : 1;
+}
+
+// File in the test working directory, removed first so a stale file from an earlier run is never read.
+inline std::string temp_path(const std::string &name) {
+    std::filesystem::path path = std::filesystem::current_path() / name;
+    std::error_code err;
+    std::filesystem::remove(path, err);
+    return path.string();
+}
+
+// n^3 cube cells of 6 tets each, corner positions jittered by +-jitter, deterministic.
+inline void make_box_mesh(Mesh_Loader::FileData &data, int n, double jitter = 0.2, unsigned seed = 5) {
+    int p = n + 1;
+    data.numberOfPoints = p * p * p;
+    data.pointList = new double[data.numberOfPoints * 3];
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> offset(-jitter, jitter);
+    for (int z = 0; z < p; z++)
+        for (int y = 0; y < p; y++)
+            for (int x = 0; x < p; x++) {
+                int i = (z * p + y) * p + x;
+                data.pointList[i * 3] = x + offset(gen);
+                data.pointList[i * 3 + 1] = y + offset(gen);
+                data.pointList[i * 3 + 2] = z + offset(gen);
+            }
+
+    const int tets[6][4] = {{0, 1, 3, 7}, {0, 1, 5, 7}, {0, 2, 3, 7}, {0, 2, 6, 7}, {0, 4, 5, 7}, {0, 4, 6, 7}};
+    data.numberOfCell = n * n * n * 6;
+    data.cellList = new Mesh_Loader::Cell[data.numberOfCell];
+    int c = 0;
+    for (int z = 0; z < n; z++)
+        for (int y = 0; y < n; y++)
+            for (int x = 0; x < n; x++) {
+                int corner[8];
+                for (int k = 0; k < 8; k++)
+                    corner[k] = ((z + (k >> 2 & 1)) * p + y + (k >> 1 & 1)) * p + x + (k & 1);
+                for (int t = 0; t < 6; t++) {
+                    data.cellList[c].numberOfPoints = 4;
+                    data.cellList[c].pointList = new int[4];
+                    for (int k = 0; k < 4; k++)
+                        data.cellList[c].pointList[k] = corner[tets[t][k]];
+                    c++;
+                }
+            }
+}
+
+// only for meshes from make_box_mesh, the loaders allocate the cells differently
+inline void free_mesh(Mesh_Loader::FileData &data) {
+    for (int i = 0; i < data.numberOfCell; i++)
+        delete[] data.cellList[i].pointList;
+    delete[] data.cellList;
+    delete[] data.pointList;
+    data.numberOfCell = data.numberOfPoints = 0;
+}
@@ -0,0 +1,119 @@
+#include <cstring>
+
+#include "vtk_hdf5.h"
+
+#include "test_util.h"
+#include "config/config_loader.h"
+
+Config config;
+
+namespace {
+    template<typename T>
+    std::vector<T> read_dataset(hid_t file, const char *name, hid_t type) {
+        std::vector<T> values;
+        hid_t dset = H5Dopen2(file, name, H5P_DEFAULT);
+        if (dset < 0)
+            return values;
+        hid_t space = H5Dget_space(dset);
+        values.resize(H5Sget_simple_extent_npoints(space));
+        if (!values.empty())
+            H5Dread(dset, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, values.data());
+        H5Sclose(space);
+        H5Dclose(dset);
+        return values;
+    }
+
+    std::vector<std::string> read_strings(hid_t file, const char *name) {
+        std::vector<std::string> values;
+        hid_t dset = H5Dopen2(file, name, H5P_DEFAULT);
+        if (dset < 0)
+            return values;
+        hid_t type = H5Dget_type(dset);
+        size_t width = H5Tget_size(type);
+        hid_t space = H5Dget_space(dset);
+        size_t number = H5Sget_simple_extent_npoints(space);
+        std::vector<char> buffer(number * width);
+        if (number > 0)
+            H5Dread(dset, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, buffer.data());
+        for (size_t i = 0; i < number; i++)
+            values.emplace_back(buffer.data() + i * width, strnlen(buffer.data() + i * width, width));
+        H5Sclose(space);
+        H5Tclose(type);
+        H5Dclose(dset);
+        return values;
+    }
+}
+
+int main() {
+    Mesh_Loader::FileData data;
+    make_box_mesh(data, 2);
+
+    const char *zone_names[3] = {"rock", "soil", "fault zone"};
+    auto &zone = data.cellDataString["zone"].content;
+    auto &density = data.cellDataDouble["density"].content;
+    auto &id = data.cellDataInt["id"].content;
+    for (int i = 0; i < data.numberOfCell; i++) {
+        zone.push_back(zone_names[i % 3]);
+        density.push_back(2.5 + i * 0.125);
+        id.push_back(i * 7);
+    }
+    auto &layer = data.pointDataString["layer"].content;
+    for (int i = 0; i < data.numberOfPoints; i++)
+        layer.push_back(i % 2 ? "top" : "bottom");
+
+    for (int level: {0, 6}) {
+        std::string path = temp_path("test_vtkhdf_" + std::to_string(level) + ".vtkhdf");
+        CHECK(Mesh_Loader::save_vtkhdf(path.c_str(), data, level));
+
+        hid_t file = H5Fopen(path.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+        CHECK(file >= 0);
+        if (file < 0)
+            continue;
+
+        auto points = read_dataset<double>(file, "/VTKHDF/Points", H5T_NATIVE_DOUBLE);
+        CHECK(points.size() == size_t(data.numberOfPoints) * 3);
+        CHECK(points.size() == size_t(data.numberOfPoints) * 3 &&
+              std::memcmp(points.data(), data.pointList, points.size() * sizeof(double)) == 0);
+
+        auto offsets = read_dataset<long long>(file, "/VTKHDF/Offsets", H5T_NATIVE_LLONG);
+        auto connectivity = read_dataset<long long>(file, "/VTKHDF/Connectivity", H5T_NATIVE_LLONG);
+        auto types = read_dataset<unsigned char>(file, "/VTKHDF/Types", H5T_NATIVE_UCHAR);
+        CHECK(offsets.size() == size_t(data.numberOfCell) + 1);
+        CHECK(types.size() == size_t(data.numberOfCell));
+        CHECK(connectivity.size() == size_t(data.numberOfCell) * 4);
+        bool same_cells = offsets.size() == size_t(data.numberOfCell) + 1 && connectivity.size() == size_t(data.numberOfCell) * 4;
+        for (int i = 0; same_cells && i < data.numberOfCell; i++) {
+            same_cells &= offsets[i] == i * 4 && types[i] == 10;
+            for (int k = 0; k < 4; k++)
+                same_cells &= connectivity[i * 4 + k] == data.cellList[i].pointList[k];
+        }
+        CHECK(same_cells);
+
+        CHECK(read_dataset<double>(file, "/VTKHDF/CellData/density", H5T_NATIVE_DOUBLE) == density);
+        CHECK(read_dataset<int>(file, "/VTKHDF/CellData/id", H5T_NATIVE_INT) == id);
+
+        //string arrays: int index into the sorted name table
+        auto zone_table = read_strings(file, "/VTKHDF/FieldData/zone_names");
+        CHECK((zone_table == std::vector<std::string>{"fault zone", "rock", "soil"}));
+        auto zone_index = read_dataset<int>(file, "/VTKHDF/CellData/zone", H5T_NATIVE_INT);
+        CHECK(zone_index.size() == zone.size());
+        bool same_zone = zone_index.size() == zone.size();
+        for (size_t i = 0; same_zone && i < zone.size(); i++)
+            same_zone &= zone_index[i] >= 0 && zone_index[i] < int(zone_table.size()) && zone_table[zone_index[i]] == zone[i];
+        CHECK(same_zone);
+
+        auto layer_table = read_strings(file, "/VTKHDF/FieldData/layer_names");
+        CHECK((layer_table == std::vector<std::string>{"bottom", "top"}));
+        auto layer_index = read_dataset<int>(file, "/VTKHDF/PointData/layer", H5T_NATIVE_INT);
+        CHECK(layer_index.size() == layer.size());
+        bool same_layer = layer_index.size() == layer.size();
+        for (size_t i = 0; same_layer && i < layer.size(); i++)
+            same_layer &= layer_table[layer_index[i]] == layer[i];
+        CHECK(same_layer);
+
+        H5Fclose(file);
+    }
+
+    free_mesh(data);
+    return test_result();
+}
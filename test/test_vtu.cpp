@@ -0,0 +1,92 @@
+#include "test_util.h"
+#include "config/config_loader.h"
+
+Config config;
+
+namespace {
+    //mesh with one array of every type load_vtu gives back unchanged, cells and points
+    void make_data(Mesh_Loader::FileData &data) {
+        make_box_mesh(data, 3);
+        for (int i = 0; i < data.numberOfCell; i++) {
+            data.cellDataDouble["density"].content.push_back(2.5 + i / 3.0);
+            data.cellDataFloat["porosity"].content.push_back(float(i) / 7.0f);
+            data.cellDataInt["zone_Z"].content.push_back(i % 5 - 1);
+            data.cellDataUInt["flags"].content.push_back(4000000000u - i);
+            data.cellDataUInt64["bulk_element_ids"].content.push_back((1ull << 40) + i);
+            data.cellDataString["rock_Z"].content.push_back(i % 3 ? "granite" : "");
+        }
+        for (int i = 0; i < data.numberOfPoints; i++) {
+            data.pointDataDouble["head"].content.push_back(-1.0e-300 * i);
+            data.pointDataInt["layer_G"].content.push_back(-i);
+            data.pointDataUInt64["bulk_node_ids"].content.push_back(i);
+        }
+    }
+
+    template<typename T>
+    bool same_arrays(const std::map<std::string, Mesh_Loader::DataArray<T>> &a, const std::map<std::string, Mesh_Loader::DataArray<T>> &b) {
+        if (a.size() != b.size())
+            return false;
+        for (auto iter = a.begin(); iter != a.end(); iter++) {
+            auto other = b.find(iter->first);
+            if (other == b.end() || other->second.content != iter->second.content)
+                return false;
+        }
+        return true;
+    }
+
+    bool same_data(const Mesh_Loader::FileData &a, const Mesh_Loader::FileData &b) {
+        if (a.numberOfPoints != b.numberOfPoints || a.numberOfCell != b.numberOfCell)
+            return false;
+        for (int i = 0; i < a.numberOfPoints * 3; i++) {
+            if (a.pointList[i] != b.pointList[i])
+                return false;
+        }
+        for (int i = 0; i < a.numberOfCell; i++) {
+            if (a.cellList[i].numberOfPoints != b.cellList[i].numberOfPoints)
+                return false;
+            for (int k = 0; k < a.cellList[i].numberOfPoints; k++) {
+                if (a.cellList[i].pointList[k] != b.cellList[i].pointList[k])
+                    return false;
+            }
+        }
+        return same_arrays(a.cellDataDouble, b.cellDataDouble) && same_arrays(a.cellDataFloat, b.cellDataFloat) &&
+               same_arrays(a.cellDataInt, b.cellDataInt) && same_arrays(a.cellDataUInt, b.cellDataUInt) &&
+               same_arrays(a.cellDataUInt64, b.cellDataUInt64) && same_arrays(a.cellDataString, b.cellDataString) &&
+               same_arrays(a.pointDataDouble, b.pointDataDouble) && same_arrays(a.pointDataInt, b.pointDataInt) &&
+               same_arrays(a.pointDataUInt64, b.pointDataUInt64);
+    }
+}
+
+int main() {
+    Mesh_Loader::FileData data;
+    make_data(data);
+
+    //VTK's writer, the parallel ascii writer and the raw appended writer all read back the same mesh
+    struct Writer {
+        const char *name;
+        bool (*save)(const char *, const Mesh_Loader::FileData &);
+    };
+    for (auto writer: {Writer{"vtk", Mesh_Loader::save_vtu}, Writer{"ascii", Mesh_Loader::save_vtu_ascii},
+                       Writer{"appended", Mesh_Loader::save_vtu_appended}}) {
+        std::string path = temp_path(std::string("test_vtu_") + writer.name + ".vtu");
+        CHECK(writer.save(path.c_str(), data));
+        Mesh_Loader::FileData loaded;
+        CHECK(Mesh_Loader::load_vtu(path.c_str(), loaded));
+        if (!same_data(data, loaded))
+            std::printf("writer %s\n", writer.name);
+        CHECK(same_data(data, loaded));
+    }
+
+    //load_file dispatches on the extension
+    {
+        Mesh_Loader::FileData loaded;
+        CHECK(Mesh_Loader::load_file(temp_path("test_vtu_dispatch.vtu").c_str(), loaded) == false);
+        std::string path = temp_path("test_vtu_dispatch.vtu");
+        CHECK(Mesh_Loader::save_vtu_appended(path.c_str(), data));
+        CHECK(Mesh_Loader::load_file(path.c_str(), loaded));
+        CHECK(same_data(data, loaded));
+    }
+
+    free_mesh(data);
+    return test_result();
+}
@@ -0,0 +1,124 @@
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#include "test_util.h"
+#include "config/config_loader.h"
+
+Config config;
+
+namespace {
+    std::string read_file(const std::string &path) {
+        std::ifstream in(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    bool same_loaded(const std::string &path, const Mesh_Loader::FileData &data) {
+        Mesh_Loader::FileData loaded;
+        if (!Mesh_Loader::load_vtu(path.c_str(), loaded) || loaded.numberOfPoints != data.numberOfPoints ||
+            loaded.numberOfCell != data.numberOfCell)
+            return false;
+        for (int i = 0; i < data.numberOfPoints * 3; i++) {
+            if (loaded.pointList[i] != data.pointList[i])
+                return false;
+        }
+        for (int i = 0; i < data.numberOfCell; i++) {
+            for (int k = 0; k < 4; k++) {
+                if (loaded.cellList[i].pointList[k] != data.cellList[i].pointList[k])
+                    return false;
+            }
+        }
+        auto same = [](const auto &a, const auto &b) {
+            if (a.size() != b.size())
+                return false;
+            for (auto iter = a.begin(); iter != a.end(); iter++) {
+                auto other = b.find(iter->first);
+                if (other == b.end() || other->second.content != iter->second.content)
+                    return false;
+            }
+            return true;
+        };
+        return same(data.cellDataInt, loaded.cellDataInt) && same(data.cellDataString, loaded.cellDataString) &&
+               same(data.cellDataDouble, loaded.cellDataDouble) && same(data.pointDataDouble, loaded.pointDataDouble);
+    }
+}
+
+int main() {
+    Mesh_Loader::FileData data;
+    make_box_mesh(data, 3);
+    for (int i = 0; i < data.numberOfCell; i++) {
+        data.cellDataString["zone_Z"].content.push_back(i % 2 ? "sand" : "clay");
+        data.cellDataDouble["density"].content.push_back(i * 0.5);
+    }
+    std::string path = temp_path("test_vtu_update.vtu");
+    CHECK(Mesh_Loader::save_vtu_appended(path.c_str(), data));
+    auto geometry_size = std::filesystem::file_size(path);
+
+    //same geometry: header and attribute blocks rewritten in place, the padded header keeps its size
+    {
+        for (int i = 0; i < data.numberOfCell; i++)
+            data.cellDataString["zone_Z"].content[i] = "a much longer group name than before";
+        for (int i = 0; i < data.numberOfPoints; i++)
+            data.pointDataDouble["head"].content.push_back(-i * 0.25);
+        std::string before = read_file(path);
+        CHECK(Mesh_Loader::update_vtu_attributes(path.c_str(), data));
+        CHECK(same_loaded(path, data));
+        std::string after = read_file(path);
+        size_t header_end = before.find("   _");
+        CHECK(header_end != std::string::npos && after.find("   _") == header_end);
+        CHECK(std::filesystem::file_size(path) > geometry_size);
+    }
+
+    //fewer attributes: the file is truncated after the new last block
+    {
+        data.cellDataString.clear();
+        data.pointDataDouble.clear();
+        data.cellDataDouble["density"].content.assign(data.numberOfCell, 1.0);
+        auto before_size = std::filesystem::file_size(path);
+        CHECK(Mesh_Loader::update_vtu_attributes(path.c_str(), data));
+        CHECK(same_loaded(path, data));
+        CHECK(std::filesystem::file_size(path) < before_size);
+
+        std::string fresh = temp_path("test_vtu_update_fresh.vtu");
+        CHECK(Mesh_Loader::save_vtu_appended(fresh.c_str(), data));
+        //same blocks as a fresh write, only the header padding differs
+        std::string fresh_text = read_file(fresh), text = read_file(path);
+        CHECK(fresh_text.substr(fresh_text.find("   _")) == text.substr(text.find("   _")));
+    }
+
+    //more array names than the header padding holds: false, file untouched
+    {
+        Mesh_Loader::FileData wide;
+        wide.numberOfPoints = data.numberOfPoints;
+        wide.pointList = data.pointList;
+        wide.numberOfCell = data.numberOfCell;
+        wide.cellList = data.cellList;
+        for (int a = 0; a < 100; a++)
+            wide.cellDataInt["a_rather_long_array_name_to_fill_the_padding_" + std::to_string(a)].content.assign(data.numberOfCell, a);
+        std::string before = read_file(path);
+        CHECK(!Mesh_Loader::update_vtu_attributes(path.c_str(), wide));
+        CHECK(read_file(path) == before);
+    }
+
+    //changed geometry: false, file untouched
+    {
+        std::string before = read_file(path);
+        data.pointList[5] += 1.0e-9;
+        CHECK(!Mesh_Loader::update_vtu_attributes(path.c_str(), data));
+        CHECK(read_file(path) == before);
+        data.pointList[5] -= 1.0e-9;
+    }
+
+    //another layout or no file: false
+    {
+        std::string ascii = temp_path("test_vtu_update_ascii.vtu");
+        CHECK(Mesh_Loader::save_vtu_ascii(ascii.c_str(), data));
+        std::string before = read_file(ascii);
+        CHECK(!Mesh_Loader::update_vtu_attributes(ascii.c_str(), data));
+        CHECK(read_file(ascii) == before);
+        CHECK(!Mesh_Loader::update_vtu_attributes(temp_path("test_vtu_update_missing.vtu").c_str(), data));
+    }
+
+    free_mesh(data);
+    return test_result();
+}